@@ -0,0 +1,156 @@
+#ifndef __MEMORYBINARYARCHIVE_HPP__
+#define __MEMORYBINARYARCHIVE_HPP__
+
+#include <cereal/cereal.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include "UE4Serialization.hpp"
+
+namespace cereal
+{
+	/**
+	* @brief Binary output archive that appends to a TArray<uint8> instead of a std::ostream. Its output is byte for
+	* byte what BinaryOutputArchive writes, so either BinaryInputArchive or MemoryBinaryInputArchive can load it.
+	*
+	* saveBinary is a slack test, a memcpy and a bump of the array's Num, all inline; only growing the allocation
+	* leaves the hot path. The array's Num always equals the bytes written so far, so it can be read or sent at any
+	* point, including after a serializer threw.
+	*/
+	class MemoryBinaryOutputArchive : public OutputArchive< MemoryBinaryOutputArchive, AllowEmptyClassElision >
+	{
+	public:
+		/**
+		 * @brief Construct, appending to bytes. Existing contents are kept.
+		 */
+		MemoryBinaryOutputArchive(TArray<uint8>& bytes)
+			: OutputArchive< MemoryBinaryOutputArchive, AllowEmptyClassElision >(this)
+			, itsBytes(bytes)
+		{}
+
+		~MemoryBinaryOutputArchive() CEREAL_NOEXCEPT = default;
+
+		/**
+		 * @brief Writes size bytes of data to the buffer.
+		 */
+		void saveBinary(const void* data, std::streamsize size)
+		{
+			if (size > itsBytes.GetSlack())
+			{
+				grow(size);
+			}
+			int32 const offset = itsBytes.AddUninitialized(static_cast<int32>(size));
+			std::memcpy(itsBytes.GetData() + offset, data, static_cast<std::size_t>(size));
+		}
+
+	private:
+		/**
+		 * @brief Reallocates so at least size more bytes fit, at least doubling the allocation.
+		 */
+		FORCENOINLINE void grow(std::streamsize size)
+		{
+			std::streamsize const needed = static_cast<std::streamsize>(itsBytes.Num()) + size;
+			if (needed > std::numeric_limits<int32>::max())
+			{
+				throw Exception("Failed to write " + std::to_string(size) + " bytes to memory buffer! Buffer would exceed int32 range");
+			}
+
+			std::streamsize const doubled = static_cast<std::streamsize>(itsBytes.Max()) * 2;
+			itsBytes.Reserve(static_cast<int32>(std::min<std::streamsize>(std::max<std::streamsize>({ needed, doubled, 256 }), std::numeric_limits<int32>::max())));
+		}
+
+		TArray<uint8>& itsBytes;
+	};
+
+	/**
+	* @brief Binary input archive that reads from a contiguous block of memory, such as the output of
+	* MemoryBinaryOutputArchive or BinaryOutputArchive. The memory is not copied and must outlive the archive.
+	*/
+	class MemoryBinaryInputArchive : public InputArchive< MemoryBinaryInputArchive, AllowEmptyClassElision >
+	{
+	public:
+		/**
+		 * @brief Construct, loading from size bytes at data.
+		 */
+		MemoryBinaryInputArchive(const void* data, std::size_t size)
+			: InputArchive< MemoryBinaryInputArchive, AllowEmptyClassElision >(this)
+			, itsCursor(static_cast<const uint8*>(data))
+			, itsEnd(static_cast<const uint8*>(data) + size)
+		{}
+
+		/**
+		 * @brief Construct, loading from the contents of bytes.
+		 */
+		MemoryBinaryInputArchive(TArray<uint8> const& bytes)
+			: MemoryBinaryInputArchive(bytes.GetData(), static_cast<std::size_t>(bytes.Num()))
+		{}
+
+		~MemoryBinaryInputArchive() CEREAL_NOEXCEPT = default;
+
+		/**
+		 * @brief Reads size bytes of data from the buffer.
+		 */
+		void loadBinary(void* const data, std::streamsize size)
+		{
+			if (size > itsEnd - itsCursor)
+			{
+				throw Exception("Failed to read " + std::to_string(size) + " bytes from memory buffer! Remaining " + std::to_string(itsEnd - itsCursor));
+			}
+			std::memcpy(data, itsCursor, static_cast<std::size_t>(size));
+			itsCursor += size;
+		}
+
+	private:
+		const uint8* itsCursor;
+		const uint8* itsEnd;
+	};
+
+	template < class T >
+	inline typename std::enable_if< std::is_arithmetic< T >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(MemoryBinaryOutputArchive& ar, T const& t)
+	{
+		ar.saveBinary(std::addressof(t), sizeof(t));
+	}
+
+	template < class T >
+	inline typename std::enable_if< std::is_arithmetic< T >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(MemoryBinaryInputArchive& ar, T& t)
+	{
+		ar.loadBinary(std::addressof(t), sizeof(t));
+	}
+
+	template < class Archive, class T >
+	inline CEREAL_ARCHIVE_RESTRICT(MemoryBinaryInputArchive, MemoryBinaryOutputArchive)
+	CEREAL_SERIALIZE_FUNCTION_NAME(Archive& ar, NameValuePair< T >& t)
+	{
+		ar(t.value);
+	}
+
+	template < class Archive, class T >
+	inline CEREAL_ARCHIVE_RESTRICT(MemoryBinaryInputArchive, MemoryBinaryOutputArchive)
+	CEREAL_SERIALIZE_FUNCTION_NAME(Archive& ar, SizeTag< T >& t)
+	{
+		ar(t.size);
+	}
+
+	template < class T >
+	inline void CEREAL_SAVE_FUNCTION_NAME(MemoryBinaryOutputArchive& ar, BinaryData< T > const& bd)
+	{
+		ar.saveBinary(bd.data, static_cast<std::streamsize>(bd.size));
+	}
+
+	template < class T >
+	inline void CEREAL_LOAD_FUNCTION_NAME(MemoryBinaryInputArchive& ar, BinaryData< T >& bd)
+	{
+		ar.loadBinary(bd.data, static_cast<std::streamsize>(bd.size));
+	}
+}
+
+CEREAL_REGISTER_ARCHIVE(cereal::MemoryBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::MemoryBinaryInputArchive)
+
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::MemoryBinaryInputArchive, cereal::MemoryBinaryOutputArchive)
+
+#endif
@@ -1,20 +1,80 @@
 #ifndef __UE4SERIALIZATION_HPP__
 #define __UE4SERIALIZATION_HPP__
 
-#include <map>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <cereal/cereal.hpp>
+#include <cereal/types/memory.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <limits>
+#include <type_traits>
 #include "SubclassOf.h"
 #include "GameFramework/Actor.h"
 #include "Math/Quat.h"
 #include "Math/Vector.h"
 #include "Math/TransformCalculus3D.h"
 #include "Math/BigInt.h"
+#include "Misc/Guid.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+/**
+* @brief When non-zero, half precision FLinearColor encoding converts a whole color per F16C instruction. Defaults to
+* on when the compiler targets F16C. MSVC does not define __F16C__, so there it follows /arch:AVX2, which implies it;
+* GCC and Clang need -mf16c on top of -mavx2.
+*/
+#ifndef CEREAL_UE4_F16C
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define CEREAL_UE4_F16C 1
+#else
+#define CEREAL_UE4_F16C 0
+#endif
+#endif
+
+/**
+* @brief x86 instruction set used by batch kernels: 0 for scalar code, 1 for SSE2 and 2 for AVX2. Defaults to the
+* highest level the compiler targets.
+*/
+#ifndef CEREAL_UE4_SIMD
+#if defined(__AVX2__)
+#define CEREAL_UE4_SIMD 2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CEREAL_UE4_SIMD 1
+#else
+#define CEREAL_UE4_SIMD 0
+#endif
+#endif
+
+/**
+* @brief Identifies builds whose key hashes agree, for TMap and TSet layout snapshots (see make_layout_snapshot). The
+* default only covers the engine version; projects should define it to their own build id, since a changed
+* GetTypeHash in game code is not detected otherwise. Snapshots only accept key types marked with
+* ue4::has_stable_key_hash.
+*/
+#ifndef CEREAL_UE4_LAYOUT_FINGERPRINT
+#define CEREAL_UE4_LAYOUT_FINGERPRINT \
+	((static_cast<uint64>(ENGINE_MAJOR_VERSION) << 56) | (static_cast<uint64>(ENGINE_MINOR_VERSION) << 48) | \
+	(static_cast<uint64>(ENGINE_PATCH_VERSION) << 40) | static_cast<uint64>(BUILT_FROM_CHANGELIST))
+#endif
+
+#if CEREAL_UE4_F16C || CEREAL_UE4_SIMD
+#include <immintrin.h>
+#endif
 
 typedef TSubclassOf<AActor> TSubclassOfType;
 
 /**
 * @brief Registration class for TSubclassOfType so it can be serialized.
+*
+* Lookups read an immutable registry snapshot and take no locks. Registrations are serialised by a mutex and, while
+* the registration is frozen (see Freeze()), publish a modified copy of the snapshot instead of changing it in place,
+* so any number of threads may save and load TSubclassOfType concurrently with the occasional late registration.
+* Outside frozen mode registrations update the snapshot in place and must not race with lookups; classes cached by
+* lookups themselves are always published as a copy.
 */
 class TSubclassOfRegistration
 {
@@ -36,7 +96,8 @@ public:
 	 */
 	void RegisterTSubclassOf(int const id, TSubclassOfType const& subclass)
 	{
-		TSubclassOfMap[id] = subclass;
+		std::lock_guard<std::mutex> const Lock(WriteMutex);
+		Register(id, subclass);
 	}
 
 	/**
@@ -45,25 +106,29 @@ public:
 	 */
 	void RegisterTSubclassOf(TSubclassOfType const& subclass)
 	{
-		TSubclassOfMap[GetNextID()] = subclass;
+		std::lock_guard<std::mutex> const Lock(WriteMutex);
+		Register(GetNextID(), subclass);
 	}
 
 	/**
 	 * @brief Obtain the identifier of a given subclass. Generally used during saving.
 	 * @param subclass The subclass to obtain the identifier of.
 	 * @return The integer identifier of subclass. If the subclass doesn't exist, then the result is
-	 * std::numeric_limits<int>::min() to indicate an invalid identifier.
+	 * std::numeric_limits<int>::min() to indicate an invalid identifier. If subclass was registered against several
+	 * identifiers, the most recent registration wins; once that one is unregistered, one of the others is returned.
 	 */
-	int GetIdOfTSubclassOf(TSubclassOfType const subclass)
+	int GetIdOfTSubclassOf(TSubclassOfType const& subclass) const
 	{
-		for (auto x : TSubclassOfMap)
+		Registry const& Current = *Published.load(std::memory_order_acquire);
+		auto const x = Current.TSubclassOfIdMap.find(subclass.Get());
+		if (x != Current.TSubclassOfIdMap.end())
 		{
-			if (x.second == subclass)
-			{
-				return x.first;
-			}
+			return x->second;
+		}
+		else
+		{
+			return std::numeric_limits<int>::min();
 		}
-		return std::numeric_limits<int>::min();
 	}
 
 	/**
@@ -72,10 +137,11 @@ public:
 	 * @return If id exists in the map, the the corresponding TSubclassOf is returned. Otherwise an empty TSubclassOf is
 	 * the result.
 	 */
-	TSubclassOfType GetTSubclassOfFromId(int const id)
+	TSubclassOfType GetTSubclassOfFromId(int const id) const
 	{
-		auto const x = TSubclassOfMap.find(id);
-		if (x != TSubclassOfMap.end())
+		Registry const& Current = *Published.load(std::memory_order_acquire);
+		auto const x = Current.TSubclassOfMap.find(id);
+		if (x != Current.TSubclassOfMap.end())
 		{
 			return x->second;
 		}
@@ -91,217 +157,2411 @@ public:
 	 */
 	int GetNumberOfRegistrations() const
 	{
-		return TSubclassOfMap.size();
+		return Published.load(std::memory_order_acquire)->TSubclassOfMap.size();
 	}
 
-	void UnregsterAll()
+	/**
+	 * @brief Removes the registration of id. The identifier becomes available to later generated registrations.
+	 * @param id The identifier to unregister.
+	 */
+	void UnregisterTSubclassOf(int const id)
 	{
-		TSubclassOfMap.clear();
+		std::lock_guard<std::mutex> const Lock(WriteMutex);
+		Unregister(id);
 	}
-private:
-	std::map<int, TSubclassOfType> TSubclassOfMap;
-
-	TSubclassOfRegistration()
-	{}
-
-	TSubclassOfRegistration(TSubclassOfRegistration const&)=delete;
-	TSubclassOfRegistration& operator=(TSubclassOfRegistration const&)=delete;
 
 	/**
-	 * @brief Obtains the next valid identifier to use.
-	 * @return An integer in the range std::numeric_limits<int>::min() + 1 to std::numeric_limits<int>::max().
-	 * std::numeric_limits<int>::min() is reserved as an invalid value.
+	 * @brief Removes the registration of subclass. Its identifier becomes available to later generated registrations.
+	 * @param subclass The subclass to unregister.
 	 */
-	int GetNextID()
+	void UnregisterTSubclassOf(TSubclassOfType const& subclass)
 	{
-		int NewId = std::numeric_limits<int>::min() + 1;
-		auto Id = TSubclassOfMap.find(NewId);
-		while (Id != TSubclassOfMap.end())
+		std::lock_guard<std::mutex> const Lock(WriteMutex);
+		auto const& Current = Registries.back()->TSubclassOfIdMap;
+		auto const x = Current.find(subclass.Get());
+		if (x != Current.end())
 		{
-			++NewId;
-			Id = TSubclassOfMap.find(NewId);
+			Unregister(x->second);
 		}
-		return NewId;
 	}
-};
 
-namespace cereal
-{
-	template <typename A>
-	void serialize(A& ar, TSubclassOfType& obj)
+	void UnregsterAll()
 	{
-		if (A::is_loading::value)
-		{
-			int x;
-			ar(x);
-			obj = TSubclassOfRegistration::instance().GetTSubclassOfFromId(x);
-		}
-		else
+		std::lock_guard<std::mutex> const Lock(WriteMutex);
+		Registry& Writable = BeginWrite();
+		Writable.TSubclassOfMap.clear();
+		Writable.TSubclassOfIdMap.clear();
+		Writable.TSubclassOfPathMap.clear();
+		Writable.TSubclassOfPathHashMap.clear();
+		EndWrite();
+		FreeIds.clear();
+		NextId = std::numeric_limits<int>::min() + 1;
+	}
+
+	/**
+	 * @brief Enters frozen mode, typically before handing archives to parallel save or load workers. From now on
+	 * registrations copy the registry and publish the copy, leaving the snapshot other threads are reading untouched.
+	 * Called on the game thread, it first resolves every class path registered without a class (see
+	 * ResolveTSubclassOfPaths()), since workers cannot load classes themselves.
+	 */
+	void Freeze()
+	{
+		if (IsInGameThread())
 		{
-			ar(TSubclassOfRegistration::instance().GetIdOfTSubclassOf(obj));
+			ResolveTSubclassOfPaths();
 		}
+		std::lock_guard<std::mutex> const Lock(WriteMutex);
+		bFrozen = true;
 	}
 
-	template <typename A>
-    void serialize(A& ar, FVector& obj)
+	/**
+	 * @brief Leaves frozen mode and releases the snapshots retired while frozen. Must only be called once no other
+	 * thread is looking up subclasses any more.
+	 */
+	void Thaw()
 	{
-		ar(obj.X);
-		ar(obj.Y);
-		ar(obj.Z);
+		std::lock_guard<std::mutex> const Lock(WriteMutex);
+		bFrozen = false;
+		Registries.erase(Registries.begin(), Registries.end() - 1);
 	}
 
-	template <typename A>
-    void serialize(A& ar, FRotator& obj)
+	/**
+	 * @brief Whether registrations are currently copy-on-write.
+	 * @return true between Freeze() and Thaw().
+	 */
+	bool IsFrozen() const
 	{
-		ar(obj.Pitch);
-		ar(obj.Roll);
-		ar(obj.Yaw);
+		std::lock_guard<std::mutex> const Lock(WriteMutex);
+		return bFrozen;
 	}
 
-	template <typename A>
-    void serialize(A& ar, FQuat& obj)
+	/** Path hash used to mark an empty or unresolvable subclass. No registered path may hash to it. */
+	static constexpr uint64 InvalidPathHash = 0;
+
+	/**
+	 * @brief 64-bit FNV-1a hash of a class path name, taken over its code units so TCHAR and ASCII literals agree.
+	 * Usable at compile time on string literals.
+	 * @param Path The null terminated class path name, e.g. TEXT("/Game/Blueprints/BP_Door.BP_Door_C").
+	 * @return The hash of Path.
+	 */
+	template <typename C>
+	static constexpr uint64 HashPath(C const* Path, uint64 const Hash = 14695981039346656037ull)
 	{
-		ar(obj.W, obj.X, obj.Y, obj.Z);
+		return *Path ? HashPath(Path + 1, (Hash ^ static_cast<typename std::make_unsigned<C>::type>(*Path)) * 1099511628211ull) : Hash;
 	}
 
-	template <typename A>
-    void serialize(A& ar, FTransform& obj)
+	/**
+	 * @brief Registers a class path for path hash identifiers (see cereal::make_class_path_hash) without loading the
+	 * class. The class is loaded by ResolveTSubclassOfPaths() or, on the game thread, the first time an archive refers
+	 * to it.
+	 * @param Path The class path name.
+	 * @return false if Path hashes to the same value as a different registered path, in which case nothing is registered.
+	 */
+	bool RegisterTSubclassOfPath(FString const& Path)
 	{
-		if (A::is_loading::value)
+		std::lock_guard<std::mutex> const Lock(WriteMutex);
+		return RegisterPath(HashPath(*Path), Path, TSubclassOfType());
+	}
+
+	/**
+	 * @brief Registers an already loaded subclass for path hash identifiers.
+	 * @param subclass The subclass to register.
+	 * @return false if subclass is empty or its path hashes to the same value as a different registered path, in
+	 * which case nothing is registered.
+	 */
+	bool RegisterTSubclassOfPath(TSubclassOfType const& subclass)
+	{
+		if (!subclass.Get())
 		{
-			FQuat rot;
-			FVector scale, trans;
-			ar(rot, scale, trans);
-			obj.SetRotation(rot);
-			obj.SetScale3D(scale);
-			obj.SetTranslation(trans);
+			return false;
 		}
-		else
+
+		FString const Path = subclass.Get()->GetPathName();
+		std::lock_guard<std::mutex> const Lock(WriteMutex);
+		return RegisterPath(HashPath(*Path), Path, subclass);
+	}
+
+	/**
+	 * @brief Obtain the path hash of a subclass. Generally used during saving. Subclasses do not need to be registered
+	 * here, but registered ones skip building the path name; the archive can only be loaded where the path is.
+	 * @param subclass The subclass to obtain the path hash of.
+	 * @return The path hash, or InvalidPathHash if subclass is empty or its hash collides with a different registered
+	 * path.
+	 */
+	uint64 GetPathHashOfTSubclassOf(TSubclassOfType const& subclass) const
+	{
+		if (!subclass.Get())
 		{
-			ar(obj.GetRotation(), obj.GetScale3D(), obj.GetTranslation());
+			return InvalidPathHash;
+		}
+
+		Registry const& Current = *Published.load(std::memory_order_acquire);
+		auto const x = Current.TSubclassOfPathHashMap.find(subclass.Get());
+		if (x != Current.TSubclassOfPathHashMap.end())
+		{
+			return x->second;
+		}
+
+		FString const Path = subclass.Get()->GetPathName();
+		uint64 const Hash = HashPath(*Path);
+		auto const Registered = Current.TSubclassOfPathMap.find(Hash);
+		if (Hash == InvalidPathHash || (Registered != Current.TSubclassOfPathMap.end() && Registered->second.Path != Path))
+		{
+			return InvalidPathHash;
 		}
+		return Hash;
 	}
 
-	template <typename A>
-    void serialize(A& ar, FString& str)
+	/**
+	 * @brief Function to get the subclass of a path hash - usually used during loading. On the game thread, paths
+	 * registered without a class are loaded and cached on first use; other threads only see classes that are already
+	 * resolved. The cache is published as a new snapshot even outside frozen mode, so loads on other threads may run
+	 * alongside; the retired snapshots are released by the next registration outside frozen mode or by Thaw().
+	 * @param Hash The path hash of the subclass.
+	 * @return The corresponding TSubclassOf, or an empty TSubclassOf if Hash is not registered, its class can't be
+	 * loaded or it is not resolved yet and this is not the game thread.
+	 */
+	TSubclassOfType GetTSubclassOfFromPathHash(uint64 const Hash)
 	{
-		if (A::is_loading::value)
+		FString Path;
 		{
-			std::string temp;
-			ar(temp);
-			str = temp.c_str();
+			Registry const& Current = *Published.load(std::memory_order_acquire);
+			auto const x = Current.TSubclassOfPathMap.find(Hash);
+			if (x == Current.TSubclassOfPathMap.end())
+			{
+				return TSubclassOfType();
+			}
+			if (x->second.Class.Get() || !IsInGameThread())
+			{
+				return x->second.Class;
+			}
+			Path = x->second.Path;
 		}
-		else
+
+		// Loading may register further classes, so it must not happen under WriteMutex.
+		TSubclassOfType const Loaded(StaticLoadClass(AActor::StaticClass(), nullptr, *Path));
+		if (Loaded.Get())
 		{
-			std::string temp(TCHAR_TO_UTF8(*str));
-			ar(temp);
+			std::lock_guard<std::mutex> const Lock(WriteMutex);
+			RegisterPath(Hash, Path, Loaded, true);
 		}
+		return Loaded;
 	}
 
-	template <typename A>
-    void serialize(A& ar, FText& str)
+	/**
+	 * @brief Loads the class of every path registered without one. Must be called on the game thread, the only thread
+	 * that may load classes; Freeze() calls it there. Classes are loaded without holding the registration lock and
+	 * then published in a single registry update.
+	 * @return The number of paths whose class could not be loaded.
+	 */
+	int ResolveTSubclassOfPaths()
 	{
-		if (A::is_loading::value)
+		std::vector<std::pair<uint64, FString>> Pending;
 		{
-			FString temp;
-			ar(temp);
-			str = FText::FromString(temp);
+			std::lock_guard<std::mutex> const Lock(WriteMutex);
+			for (auto const& x : Registries.back()->TSubclassOfPathMap)
+			{
+				if (!x.second.Class.Get())
+				{
+					Pending.emplace_back(x.first, x.second.Path);
+				}
+			}
 		}
-		else
+
+		std::vector<std::pair<uint64, TSubclassOfType>> Loaded;
+		for (auto const& x : Pending)
 		{
-			FString temp;
-			temp = str.ToString();
-			ar(temp);
-		}	
+			TSubclassOfType const Class(StaticLoadClass(AActor::StaticClass(), nullptr, *x.second));
+			if (Class.Get())
+			{
+				Loaded.emplace_back(x.first, Class);
+			}
+		}
+
+		if (!Loaded.empty())
+		{
+			std::lock_guard<std::mutex> const Lock(WriteMutex);
+			Registry& Writable = BeginWrite();
+			for (auto const& x : Loaded)
+			{
+				auto const Entry = Writable.TSubclassOfPathMap.find(x.first);
+				if (Entry != Writable.TSubclassOfPathMap.end() && !Entry->second.Class.Get())
+				{
+					Entry->second.Class = x.second;
+					Writable.TSubclassOfPathHashMap[x.second.Get()] = x.first;
+				}
+			}
+			EndWrite();
+		}
+		return static_cast<int>(Pending.size() - Loaded.size());
 	}
+private:
+	/** A path hash registration. Class stays empty until the path is first resolved. */
+	struct PathRegistration
+	{
+		FString Path;
+		TSubclassOfType Class;
+	};
 
-	template <typename A>
-    void serialize(A& ar, FName& str)
+	/** One version of the registry. Readers only ever see it through Published. */
+	struct Registry
 	{
-		if (A::is_loading::value)
+		std::unordered_map<int, TSubclassOfType> TSubclassOfMap;
+		/** Reverse index of TSubclassOfMap, kept in sync by Register and Unregister. */
+		std::unordered_map<UClass*, int> TSubclassOfIdMap;
+		std::unordered_map<uint64, PathRegistration> TSubclassOfPathMap;
+		/** Reverse index of the resolved entries of TSubclassOfPathMap. */
+		std::unordered_map<UClass*, uint64> TSubclassOfPathHashMap;
+	};
+
+	/** The published registry is always Registries.back(); older entries were retired while frozen. */
+	std::vector<std::unique_ptr<Registry>> Registries;
+	std::atomic<Registry const*> Published;
+	mutable std::mutex WriteMutex;
+	bool bFrozen = false;
+	/** Identifiers returned by UnregisterTSubclassOf, reused before NextId is advanced. */
+	std::vector<int> FreeIds;
+	/** Every identifier from std::numeric_limits<int>::min() + 1 up to, but not including, NextId has been handed out. */
+	int NextId = std::numeric_limits<int>::min() + 1;
+
+	TSubclassOfRegistration()
+	{
+		Registries.emplace_back(new Registry());
+		Published.store(Registries.back().get(), std::memory_order_release);
+	}
+
+	TSubclassOfRegistration(TSubclassOfRegistration const&)=delete;
+	TSubclassOfRegistration& operator=(TSubclassOfRegistration const&)=delete;
+
+	/**
+	 * @brief Obtains the registry a writer may modify. While frozen, or when bConcurrent says lookups may be running,
+	 * this is a fresh copy of the published registry. Otherwise no lookup can be reading a retired snapshot, so they
+	 * are released and the published registry is modified in place. Requires WriteMutex.
+	 */
+	Registry& BeginWrite(bool const bConcurrent = false)
+	{
+		if (bFrozen || bConcurrent)
 		{
-			FString temp;
-			ar(temp);
-			str = FName(*temp);
+			Registries.emplace_back(new Registry(*Registries.back()));
 		}
 		else
 		{
-			FString temp = str.ToString();
-			ar(temp);
-		}		
+			Registries.erase(Registries.begin(), Registries.end() - 1);
+		}
+		return *Registries.back();
 	}
 
-	template < typename A >
-	inline void serialize(A& ar, FBox& in)
+	/**
+	 * @brief Publishes the registry returned by BeginWrite. Requires WriteMutex.
+	 */
+	void EndWrite()
 	{
-		ar(make_nvp("IsValid", in.Max), make_nvp("Min", in.Min), make_nvp("Max", in.Max));
+		Published.store(Registries.back().get(), std::memory_order_release);
 	}
 
-	template < typename A >
-	inline void serialize(A& ar, FBox2D& in)
+	void Register(int const id, TSubclassOfType const& subclass)
 	{
-		ar(make_nvp("bIsValid", in.Max), make_nvp("Min", in.Min), make_nvp("Max", in.Max));
+		Registry& Writable = BeginWrite();
+		TSubclassOfType& Entry = Writable.TSubclassOfMap[id];
+		UClass* const Previous = Entry.Get();
+		Entry = subclass;
+		if (Previous && Previous != subclass.Get())
+		{
+			Unlink(Writable, Previous, id);
+		}
+		Writable.TSubclassOfIdMap[subclass.Get()] = id;
+		EndWrite();
 	}
 
-	template < typename A >
-	inline void serialize(A& ar, FCapsuleShape& in)
+	/**
+	 * @brief Adds or completes a path hash registration. Requires WriteMutex.
+	 * @param bConcurrent Whether lookups may be running, as when a lookup itself caches a class; see BeginWrite.
+	 * @return false on a hash collision with a different path.
+	 */
+	bool RegisterPath(uint64 const Hash, FString const& Path, TSubclassOfType const& subclass, bool const bConcurrent = false)
 	{
-		ar(make_nvp("Center", in.Center));
-		ar(make_nvp("Radius", in.Radius));
-		ar(make_nvp("Orientation", in.Orientation));
-		ar(make_nvp("Length", in.Length));
+		auto const& Current = Registries.back()->TSubclassOfPathMap;
+		auto const Existing = Current.find(Hash);
+		if (Hash == InvalidPathHash || (Existing != Current.end() && Existing->second.Path != Path))
+		{
+			return false;
+		}
+		if (Existing != Current.end() && (!subclass.Get() || Existing->second.Class.Get() == subclass.Get()))
+		{
+			return true;
+		}
+
+		Registry& Writable = BeginWrite(bConcurrent);
+		PathRegistration& Entry = Writable.TSubclassOfPathMap[Hash];
+		Entry.Path = Path;
+		if (subclass.Get())
+		{
+			Entry.Class = subclass;
+			Writable.TSubclassOfPathHashMap[subclass.Get()] = Hash;
+		}
+		EndWrite();
+		return true;
 	}
 
-	template < typename A >
-	inline void serialize(A& ar, FColor& in)
+	void Unregister(int const id)
 	{
-		ar(make_nvp("R", in.R), make_nvp("G", in.G), make_nvp("B", in.B), make_nvp("A", in.A));
+		if (Registries.back()->TSubclassOfMap.find(id) == Registries.back()->TSubclassOfMap.end())
+		{
+			return;
+		}
+
+		Registry& Writable = BeginWrite();
+		auto const x = Writable.TSubclassOfMap.find(id);
+		UClass* const Class = x->second.Get();
+		Writable.TSubclassOfMap.erase(x);
+		Unlink(Writable, Class, id);
+		EndWrite();
+		FreeIds.push_back(id);
 	}
 
-	template < typename A >
-	inline std::string save_minimal(A& ar, const FDateTime& in)
+	/**
+	 * @brief Updates the reverse index after id stopped referring to Class. If Class was found through id it is
+	 * pointed at another identifier Class is still registered against, or dropped if there is none. Requires WriteMutex.
+	 */
+	static void Unlink(Registry& Writable, UClass* const Class, int const id)
 	{
-		return std::string(TCHAR_TO_UTF8(*in.ToIso8601()));
+		auto const Reverse = Writable.TSubclassOfIdMap.find(Class);
+		if (Reverse == Writable.TSubclassOfIdMap.end() || Reverse->second != id)
+		{
+			return;
+		}
+		for (auto const& x : Writable.TSubclassOfMap)
+		{
+			if (x.second.Get() == Class)
+			{
+				Reverse->second = x.first;
+				return;
+			}
+		}
+		Writable.TSubclassOfIdMap.erase(Reverse);
+	}
+
+	/**
+	 * @brief Obtains the next valid identifier to use. Requires WriteMutex.
+	 * @return An integer in the range std::numeric_limits<int>::min() + 1 to std::numeric_limits<int>::max().
+	 * std::numeric_limits<int>::min() is reserved as an invalid value. Freed identifiers are reused first; identifiers
+	 * taken by explicit registrations are skipped, each at most once, so allocation is amortised O(1).
+	 */
+	int GetNextID()
+	{
+		auto const& Current = Registries.back()->TSubclassOfMap;
+		while (!FreeIds.empty())
+		{
+			int const FreeId = FreeIds.back();
+			FreeIds.pop_back();
+			if (Current.find(FreeId) == Current.end())
+			{
+				return FreeId;
+			}
+		}
+
+		while (Current.find(NextId) != Current.end())
+		{
+			++NextId;
+		}
+		return NextId++;
 	}
+};
+
+namespace cereal
+{
+	namespace ue4
+	{
+		/**
+		 * @brief True for archives that save raw binary data, such as BinaryOutputArchive.
+		 */
+		template < typename A >
+		struct is_binary_output : traits::is_output_serializable< BinaryData< char >, typename std::remove_cv< A >::type >
+		{};
+
+		/**
+		 * @brief True for archives that load raw binary data, such as BinaryInputArchive.
+		 */
+		template < typename A >
+		struct is_binary_input : traits::is_input_serializable< BinaryData< char >, typename std::remove_cv< A >::type >
+		{};
+
+		/**
+		 * @brief True for binary archives of either direction.
+		 */
+		template < typename A >
+		struct is_binary_archive : std::integral_constant< bool, is_binary_output< A >::value || is_binary_input< A >::value >
+		{};
+
+		/**
+		 * @brief True for archives with their own saveVarint, such as VarintBinaryOutputArchive.
+		 */
+		template < typename A, typename Enable = void >
+		struct has_save_varint : std::false_type
+		{};
+
+		template < typename A >
+		struct has_save_varint< A, decltype(void(std::declval< A& >().saveVarint(uint64()))) > : std::true_type
+		{};
+
+		/**
+		 * @brief True for archives with their own loadVarint, such as VarintBinaryInputArchive.
+		 */
+		template < typename A, typename Enable = void >
+		struct has_load_varint : std::false_type
+		{};
+
+		template < typename A >
+		struct has_load_varint< A, decltype(void(std::declval< A& >().loadVarint())) > : std::true_type
+		{};
+
+		/**
+		 * @brief Writes v as a LEB128 varint: seven bits per byte, least significant group first, high bit set on every
+		 * byte but the last. Archives with their own saveVarint write it themselves.
+		 */
+		template < typename A >
+		inline typename std::enable_if< has_save_varint< A >::value >::type
+		save_varint(A& ar, uint64 const v)
+		{
+			ar.saveVarint(v);
+		}
+
+		template < typename A >
+		inline typename std::enable_if< !has_save_varint< A >::value >::type
+		save_varint(A& ar, uint64 v)
+		{
+			uint8 buffer[10];
+			std::size_t size = 0;
+			while (v >= 0x80)
+			{
+				buffer[size++] = static_cast<uint8>(v) | 0x80;
+				v >>= 7;
+			}
+			buffer[size++] = static_cast<uint8>(v);
+			ar(binary_data(static_cast<uint8 const*>(buffer), size));
+		}
+
+		/**
+		 * @brief Reads a varint written by save_varint. Throws if it does not fit 64 bits, so the tenth byte may only
+		 * be 0 or 1. Archives with their own loadVarint read it themselves.
+		 */
+		template < typename A >
+		inline typename std::enable_if< has_load_varint< A >::value, uint64 >::type
+		load_varint(A& ar)
+		{
+			return ar.loadVarint();
+		}
+
+		template < typename A >
+		inline typename std::enable_if< !has_load_varint< A >::value, uint64 >::type
+		load_varint(A& ar)
+		{
+			uint64 v = 0;
+			for (unsigned shift = 0; shift < 64; shift += 7)
+			{
+				uint8 byte;
+				ar(byte);
+				if (shift == 63 && byte > 1)
+				{
+					break;
+				}
+				v |= static_cast<uint64>(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+				{
+					return v;
+				}
+			}
+			throw Exception("Malformed varint");
+		}
+
+		/**
+		 * @brief Maps signed values to unsigned ones so that small magnitudes of either sign stay small as varints.
+		 */
+		inline uint64 zigzag_encode(int64 const v)
+		{
+			return (static_cast<uint64>(v) << 1) ^ static_cast<uint64>(v >> 63);
+		}
+
+		inline int64 zigzag_decode(uint64 const v)
+		{
+			return static_cast<int64>(v >> 1) ^ -static_cast<int64>(v & 1);
+		}
+
+		/**
+		 * @brief Describes types whose memory is a packed run of element_type values, so that contiguous arrays of them
+		 * can be written to and read from binary archives as a single block. element_type is also the unit that
+		 * portable binary archives byte swap.
+		 */
+		template < typename T, typename Enable = void >
+		struct binary_block_traits : std::false_type
+		{};
+
+		template < typename T >
+		struct binary_block_traits< T, typename std::enable_if< std::is_arithmetic< T >::value && !std::is_same< T, bool >::value >::type >
+			: std::true_type
+		{
+			using element_type = T;
+		};
+
+		/**
+		 * @brief True for binary archives that encode integers wider than a byte in a variable length form, such as
+		 * VarintBinaryOutputArchive. Blocks of such integers must then go through the archive value by value.
+		 */
+		template < typename A >
+		struct has_compact_integers : std::false_type
+		{};
+
+		/**
+		 * @brief Saves an integer that is usually large, such as a hash or a tick count, at its full width. Archives with
+		 * compact integers would spend more bytes on it as a varint, so there it goes out raw through binary_data.
+		 */
+		template < typename A, typename T >
+		inline typename std::enable_if< has_compact_integers< typename std::remove_cv< A >::type >::value >::type
+		save_fixed(A& ar, T const& value)
+		{
+			ar(binary_data(std::addressof(value), sizeof(value)));
+		}
+
+		template < typename A, typename T >
+		inline typename std::enable_if< !has_compact_integers< typename std::remove_cv< A >::type >::value >::type
+		save_fixed(A& ar, T const& value)
+		{
+			ar(value);
+		}
+
+		/**
+		 * @brief Loads an integer saved with save_fixed.
+		 */
+		template < typename A, typename T >
+		inline typename std::enable_if< has_compact_integers< typename std::remove_cv< A >::type >::value >::type
+		load_fixed(A& ar, T& value)
+		{
+			ar(binary_data(std::addressof(value), sizeof(value)));
+		}
+
+		template < typename A, typename T >
+		inline typename std::enable_if< !has_compact_integers< typename std::remove_cv< A >::type >::value >::type
+		load_fixed(A& ar, T& value)
+		{
+			ar(value);
+		}
+
+		/**
+		 * @brief Opts binary archive A into the compact encodings of FName, FText, FDateTime, FTimespan, TBigInt and
+		 * FTransform: per archive name and text tables, int64 ticks, raw words and elided default components. They change
+		 * the bytes written, so other binary archives keep the format of earlier releases and still load old saves.
+		 * Archives with compact integers have no earlier format and opt in. To opt in another archive, specialize this
+		 * to std::true_type for its output and input archive, visible everywhere either is used.
+		 */
+		template < typename A >
+		struct has_compact_format : has_compact_integers< A >
+		{};
+
+		/**
+		 * @brief True for binary output archives using the compact encodings, see has_compact_format.
+		 */
+		template < typename A >
+		struct is_compact_output
+			: std::conditional< is_binary_output< A >::value, has_compact_format< typename std::remove_cv< A >::type >, std::false_type >::type
+		{};
+
+		/**
+		 * @brief True for binary input archives using the compact encodings, see has_compact_format.
+		 */
+		template < typename A >
+		struct is_compact_input
+			: std::conditional< is_binary_input< A >::value, has_compact_format< typename std::remove_cv< A >::type >, std::false_type >::type
+		{};
+
+		template < typename A >
+		struct is_compact_archive : std::integral_constant< bool, is_compact_output< A >::value || is_compact_input< A >::value >
+		{};
+
+		/**
+		 * @brief True if archive A stores the elements of the binary block E in their raw in-memory form.
+		 */
+		template < typename A, typename E, bool = binary_block_traits< E >::value >
+		struct is_raw_block : std::false_type
+		{};
+
+		template < typename A, typename E >
+		struct is_raw_block< A, E, true >
+			: std::integral_constant< bool, !(std::is_integral< typename binary_block_traits< E >::element_type >::value &&
+				sizeof(typename binary_block_traits< E >::element_type) > 1 && has_compact_integers< typename std::remove_cv< A >::type >::value) >
+		{};
+
+		/**
+		 * @brief True if arrays of E can be saved to archive A as one binary block.
+		 */
+		template < typename A, typename E >
+		struct is_binary_block_output
+			: std::integral_constant< bool, is_raw_block< A, E >::value && traits::is_output_serializable< BinaryData< E >, A >::value >
+		{};
+
+		/**
+		 * @brief True if arrays of E can be loaded from archive A as one binary block.
+		 */
+		template < typename A, typename E >
+		struct is_binary_block_input
+			: std::integral_constant< bool, is_raw_block< A, E >::value && traits::is_input_serializable< BinaryData< E >, A >::value >
+		{};
+
+		/**
+		 * @brief Marks binary blocks whose single values, too, go to binary archives as one binary_data blob instead of
+		 * field by field. Their field-wise serializers are then only used by text archives. Set with
+		 * CEREAL_UE4_TRIVIALLY_SERIALIZABLE.
+		 */
+		template < typename T >
+		struct is_trivially_serializable : std::false_type
+		{};
+
+		template < typename A, typename T >
+		struct is_raw_binary_archive : std::integral_constant< bool, is_binary_archive< A >::value && is_raw_block< A, T >::value >
+		{};
+
+		/**
+		 * @brief True if archive A serializes T as one binary_data blob. The archive is only inspected for marked types;
+		 * doing so for BinaryData itself would recurse into is_binary_archive.
+		 */
+		template < typename A, typename T >
+		struct is_binary_blob : std::conditional< is_trivially_serializable< T >::value, is_raw_binary_archive< A, T >, std::false_type >::type
+		{};
+
+		/**
+		 * @brief A T read from the archive field name, for values that must exist before they can be placed in a
+		 * container, such as map keys. Types with load_and_construct are built directly from the archive; other types
+		 * are default constructed and then loaded.
+		 */
+		template < typename A, typename T, typename Enable = void >
+		class loaded_value
+		{
+		public:
+			explicit loaded_value(A& a)
+			{
+				a(value);
+			}
+
+			loaded_value(A& a, char const* name)
+			{
+				a(make_nvp(name, value));
+			}
+
+			T& get()
+			{
+				return value;
+			}
+
+		private:
+			T value;
+		};
+
+		template < typename A, typename T >
+		class loaded_value< A, T, typename std::enable_if< traits::has_load_and_construct< T, A >::value >::type >
+		{
+		public:
+			explicit loaded_value(A& a)
+			{
+				memory_detail::LoadAndConstructLoadWrapper< A, T > wrapper(reinterpret_cast< T* >(&storage));
+				a(wrapper);
+			}
+
+			loaded_value(A& a, char const* name)
+			{
+				memory_detail::LoadAndConstructLoadWrapper< A, T > wrapper(reinterpret_cast< T* >(&storage));
+				a(make_nvp(name, wrapper));
+			}
+
+			~loaded_value()
+			{
+				get().~T();
+			}
+
+			loaded_value(loaded_value const&) = delete;
+			loaded_value& operator=(loaded_value const&) = delete;
+
+			T& get()
+			{
+				return *reinterpret_cast< T* >(&storage);
+			}
+
+		private:
+			typename std::aligned_storage< sizeof(T), alignof(T) >::type storage;
+		};
+
+		/**
+		 * @brief Appends one element to out and loads it. Types with load_and_construct are built outside the array and
+		 * moved in, so a load that throws never leaves an unconstructed element behind; other types are default
+		 * constructed in place once and then loaded.
+		 */
+		template < typename A, typename E, typename L >
+		inline typename std::enable_if< traits::has_load_and_construct< E, A >::value >::type
+		load_emplace(A& a, TArray< E, L >& out)
+		{
+			loaded_value< A, E > e(a);
+			out.Emplace(MoveTemp(e.get()));
+		}
+
+		template < typename A, typename E, typename L >
+		inline typename std::enable_if< !traits::has_load_and_construct< E, A >::value >::type
+		load_emplace(A& a, TArray< E, L >& out)
+		{
+			a(out.Emplace_GetRef());
+		}
+	}
+
+/**
+ * @brief Marks Type as a packed block of Count values of Element for ue4::binary_block_traits.
+ */
+#define CEREAL_UE4_BINARY_BLOCK(Type, Element, Count) \
+	namespace ue4 \
+	{ \
+		template <> \
+		struct binary_block_traits< Type > : std::true_type \
+		{ \
+			using element_type = Element; \
+			static_assert(sizeof(Type) == sizeof(Element) * (Count), #Type " is not a packed block of " #Element); \
+			static_assert(std::is_trivially_copyable< Type >::value, #Type " is not trivially copyable"); \
+		}; \
+	}
+
+/**
+ * @brief Marks Type as a packed block of Count values of Element that binary archives save and load as one blob, both
+ * on its own and in arrays. The blob holds the fields in declaration order, which must match the order the type's
+ * field-wise serializer uses, so binary output is the same as field by field.
+ */
+#define CEREAL_UE4_TRIVIALLY_SERIALIZABLE(Type, Element, Count) \
+	CEREAL_UE4_BINARY_BLOCK(Type, Element, Count) \
+	namespace ue4 \
+	{ \
+		template <> \
+		struct is_trivially_serializable< Type > : std::true_type \
+		{}; \
+	}
+
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FVector, float, 3)
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FVector2D, float, 2)
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FTwoVectors, float, 6)
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FPlane, float, 4)
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FSphere, float, 4)
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FIntPoint, int32, 2)
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FIntRect, int32, 4)
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FIntVector, int32, 3)
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FIntVector4, int32, 4)
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FUintVector4, uint32, 4)
+	CEREAL_UE4_TRIVIALLY_SERIALIZABLE(FLinearColor, float, 4)
+	namespace ue4
+	{
+		/**
+		 * @brief Registration ids counted from std::numeric_limits<int>::min(), for archives with compact integers:
+		 * generated ids then start at 1 and the invalid id is 0, where the raw ids would take five bytes each.
+		 */
+		inline uint32 compact_subclass_id(int const id)
+		{
+			return static_cast<uint32>(id) - static_cast<uint32>(std::numeric_limits<int>::min());
+		}
+
+		inline int expand_subclass_id(uint32 const v)
+		{
+			return static_cast<int>(v + static_cast<uint32>(std::numeric_limits<int>::min()));
+		}
+	}
+
+	namespace ue4
+	{
+		template < typename E >
+		struct binary_block_traits< TInterval< E >, typename std::enable_if< std::is_arithmetic< E >::value && !std::is_same< E, bool >::value >::type >
+			: std::true_type
+		{
+			using element_type = E;
+			static_assert(sizeof(TInterval< E >) == 2 * sizeof(E), "TInterval is not a packed pair");
+		};
+
+		template < typename E >
+		struct is_trivially_serializable< TInterval< E > > : binary_block_traits< TInterval< E > >
+		{};
+	}
+
+	template < typename A, typename T >
+	inline typename std::enable_if< ue4::is_binary_blob< A, T >::value >::type
+	serialize(A& ar, T& in)
+	{
+		using E = typename ue4::binary_block_traits< T >::element_type;
+		ar(binary_data(reinterpret_cast< E* >(&in), sizeof(T)));
+	}
+
+	template <typename A>
+	void serialize(A& ar, TSubclassOfType& obj)
+	{
+		auto& Registration = TSubclassOfRegistration::instance();
+		if (ue4::has_compact_integers< typename std::remove_cv< A >::type >::value)
+		{
+			uint32 x = A::is_loading::value ? 0 : ue4::compact_subclass_id(Registration.GetIdOfTSubclassOf(obj));
+			ar(x);
+			if (A::is_loading::value)
+			{
+				obj = Registration.GetTSubclassOfFromId(ue4::expand_subclass_id(x));
+			}
+		}
+		else if (A::is_loading::value)
+		{
+			int x;
+			ar(x);
+			obj = Registration.GetTSubclassOfFromId(x);
+		}
+		else
+		{
+			ar(Registration.GetIdOfTSubclassOf(obj));
+		}
+	}
+
+	/**
+	 * @brief Wrapper identifying a TSubclassOfType by the 64-bit hash of its class path (see
+	 * TSubclassOfRegistration::HashPath) instead of its registration id, so saves do not depend on registration order.
+	 * Loading throws if the path is not registered with RegisterTSubclassOfPath or its class is not resolved; off the
+	 * game thread, resolve classes first with ResolveTSubclassOfPaths() or Freeze(). Create with make_class_path_hash.
+	 */
+	template < typename T >
+	struct ClassPathHash
+	{
+		T value;
+	};
+
+	/**
+	 * @brief Serializes the subclass v by class path hash.
+	 */
+	template < typename T >
+	inline ClassPathHash< T > make_class_path_hash(T&& v)
+	{
+		return { std::forward< T >(v) };
+	}
+
+	template < typename A, typename T >
+	inline void CEREAL_SAVE_FUNCTION_NAME(A& ar, ClassPathHash< T > const& in)
+	{
+		uint64 const x = TSubclassOfRegistration::instance().GetPathHashOfTSubclassOf(in.value);
+		if (x == TSubclassOfRegistration::InvalidPathHash && in.value.Get())
+		{
+			throw Exception("TSubclassOf path hash collides with a different registered class path");
+		}
+		ue4::save_fixed(ar, x);
+	}
+
+	template < typename A, typename T >
+	inline void CEREAL_LOAD_FUNCTION_NAME(A& ar, ClassPathHash< T >& out)
+	{
+		uint64 x;
+		ue4::load_fixed(ar, x);
+		out.value = TSubclassOfRegistration::instance().GetTSubclassOfFromPathHash(x);
+		if (!out.value.Get() && x != TSubclassOfRegistration::InvalidPathHash)
+		{
+			throw Exception("TSubclassOf path hash " + std::to_string(x) + " is not registered or its class is not resolved");
+		}
+	}
+
+	template <typename A>
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FVector >::value >::type
+	serialize(A& ar, FVector& obj)
+	{
+		ar(obj.X);
+		ar(obj.Y);
+		ar(obj.Z);
+	}
+
+	template <typename A>
+    void serialize(A& ar, FRotator& obj)
+	{
+		ar(obj.Pitch);
+		ar(obj.Roll);
+		ar(obj.Yaw);
+	}
+
+	template <typename A>
+    void serialize(A& ar, FQuat& obj)
+	{
+		ar(obj.W, obj.X, obj.Y, obj.Z);
+	}
+
+	namespace ue4
+	{
+		/** Bits of the mask that prefixes compact binary FTransforms. A clear bit means the component has its default value. */
+		enum transform_components : uint8
+		{
+			transform_rotation = 1,
+			transform_scale = 2,
+			transform_translation = 4,
+			transform_all = transform_rotation | transform_scale | transform_translation
+		};
+
+		/**
+		 * @brief The components of a transform in one aligned block, each laid out like its vector register: rotation as
+		 * X, Y, Z, W and scale and translation as X, Y, Z with an unused fourth lane.
+		 */
+		struct transform_block
+		{
+			alignas(16) float Rotation[4];
+			alignas(16) float Scale3D[4];
+			alignas(16) float Translation[4];
+		};
+
+		/**
+		 * @brief Copies the components of t into a transform_block. Vectorized transforms store their registers straight
+		 * into the block rather than building FQuat and FVector temporaries through the getters.
+		 */
+		inline void store_transform(FTransform const& t, transform_block& out)
+		{
+#if ENABLE_VECTORIZED_TRANSFORM
+			VectorStoreAligned(t.GetRotationRegister(), out.Rotation);
+			VectorStoreAligned(t.GetScale3DRegister(), out.Scale3D);
+			VectorStoreAligned(t.GetTranslationRegister(), out.Translation);
+#else
+			FQuat const& rotation = t.GetRotation();
+			FVector const& scale = t.GetScale3D();
+			FVector const& translation = t.GetTranslation();
+			out.Rotation[0] = rotation.X;
+			out.Rotation[1] = rotation.Y;
+			out.Rotation[2] = rotation.Z;
+			out.Rotation[3] = rotation.W;
+			out.Scale3D[0] = scale.X;
+			out.Scale3D[1] = scale.Y;
+			out.Scale3D[2] = scale.Z;
+			out.Translation[0] = translation.X;
+			out.Translation[1] = translation.Y;
+			out.Translation[2] = translation.Z;
+#endif
+		}
+
+		/**
+		 * @brief Works out which components of a transform differ from identity rotation, unit scale and zero translation.
+		 */
+		inline uint8 non_default_components(transform_block const& t)
+		{
+			uint8 mask = 0;
+			if (t.Rotation[0] != 0 || t.Rotation[1] != 0 || t.Rotation[2] != 0 || t.Rotation[3] != 1)
+			{
+				mask |= transform_rotation;
+			}
+			if (t.Scale3D[0] != 1 || t.Scale3D[1] != 1 || t.Scale3D[2] != 1)
+			{
+				mask |= transform_scale;
+			}
+			if (t.Translation[0] != 0 || t.Translation[1] != 0 || t.Translation[2] != 0)
+			{
+				mask |= transform_translation;
+			}
+			return mask;
+		}
+
+		/**
+		 * @brief Number of floats following a transform mask.
+		 */
+		inline std::size_t transform_value_count(uint8 const mask)
+		{
+			return ((mask & transform_rotation) ? 4 : 0) + ((mask & transform_scale) ? 3 : 0) + ((mask & transform_translation) ? 3 : 0);
+		}
+	}
+
+	// Binary archives write the components, rotation as W, X, Y, Z then scale and translation as X, Y, Z, as one block
+	// of floats. Archives using the compact format (see ue4::has_compact_format) prefix it with a mask of non-default
+	// components and skip the rest, so identity rotations, unit scales and zero translations cost nothing beyond the
+	// mask byte.
+	template <typename A>
+	inline typename std::enable_if< ue4::is_binary_output< A >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& ar, FTransform const& obj)
+	{
+		ue4::transform_block block;
+		ue4::store_transform(obj, block);
+		bool const compact = ue4::has_compact_format< A >::value;
+		uint8 const mask = compact ? ue4::non_default_components(block) : ue4::transform_all;
+
+		float values[10];
+		std::size_t count = 0;
+		if (mask & ue4::transform_rotation)
+		{
+			values[count++] = block.Rotation[3];
+			values[count++] = block.Rotation[0];
+			values[count++] = block.Rotation[1];
+			values[count++] = block.Rotation[2];
+		}
+		if (mask & ue4::transform_scale)
+		{
+			values[count++] = block.Scale3D[0];
+			values[count++] = block.Scale3D[1];
+			values[count++] = block.Scale3D[2];
+		}
+		if (mask & ue4::transform_translation)
+		{
+			values[count++] = block.Translation[0];
+			values[count++] = block.Translation[1];
+			values[count++] = block.Translation[2];
+		}
+
+		if (compact)
+		{
+			ar(mask);
+		}
+		ar(binary_data(static_cast<float const*>(values), count * sizeof(float)));
+	}
+
+	template <typename A>
+	inline typename std::enable_if< ue4::is_binary_input< A >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& ar, FTransform& obj)
+	{
+		uint8 mask = ue4::transform_all;
+		if (ue4::has_compact_format< A >::value)
+		{
+			ar(mask);
+		}
+
+		float values[10];
+		ar(binary_data(static_cast<float*>(values), ue4::transform_value_count(mask) * sizeof(float)));
+
+		FQuat rotation = FQuat::Identity;
+		FVector scale = FVector::OneVector;
+		FVector translation = FVector::ZeroVector;
+		float const* value = values;
+		if (mask & ue4::transform_rotation)
+		{
+			rotation = FQuat(value[1], value[2], value[3], value[0]);
+			value += 4;
+		}
+		if (mask & ue4::transform_scale)
+		{
+			scale = FVector(value[0], value[1], value[2]);
+			value += 3;
+		}
+		if (mask & ue4::transform_translation)
+		{
+			translation = FVector(value[0], value[1], value[2]);
+		}
+		obj = FTransform(rotation, translation, scale);
+	}
+
+	template <typename A>
+	inline typename std::enable_if< !ue4::is_binary_archive< A >::value >::type
+	serialize(A& ar, FTransform& obj)
+	{
+		if (A::is_loading::value)
+		{
+			FQuat rot;
+			FVector scale, trans;
+			ar(rot, scale, trans);
+			obj.SetRotation(rot);
+			obj.SetScale3D(scale);
+			obj.SetTranslation(trans);
+		}
+		else
+		{
+			ar(obj.GetRotation(), obj.GetScale3D(), obj.GetTranslation());
+		}
+	}
+
+	namespace ue4
+	{
+		/**
+		 * @brief Saves value into the node the archive is currently in instead of opening one of its own, so that a
+		 * field wrapper leaves text output exactly as the unwrapped field would be. Covers the non-member save and
+		 * serialize functions the UE4 types use.
+		 */
+		template < typename A, typename T >
+		inline typename std::enable_if< traits::has_non_member_save< T, A >::value >::type
+		save_inline(A& ar, T const& value)
+		{
+			CEREAL_SAVE_FUNCTION_NAME(ar, value);
+		}
+
+		template < typename A, typename T >
+		inline typename std::enable_if< traits::has_non_member_serialize< T, A >::value >::type
+		save_inline(A& ar, T const& value)
+		{
+			CEREAL_SERIALIZE_FUNCTION_NAME(ar, const_cast< T& >(value));
+		}
+
+		template < typename A, typename T >
+		inline typename std::enable_if< traits::has_non_member_load< T, A >::value >::type
+		load_inline(A& ar, T& value)
+		{
+			CEREAL_LOAD_FUNCTION_NAME(ar, value);
+		}
+
+		template < typename A, typename T >
+		inline typename std::enable_if< traits::has_non_member_serialize< T, A >::value >::type
+		load_inline(A& ar, T& value)
+		{
+			CEREAL_SERIALIZE_FUNCTION_NAME(ar, value);
+		}
+
+		/**
+		 * @brief Binary encoding of an opt-in field wrapper W, such as Quantized. Specializations derive from
+		 * std::true_type and provide static save and load functions for binary archives. Text archives ignore the
+		 * wrapper and serialize its value member in place, so wrapped and unwrapped text documents read each other.
+		 */
+		template < typename W >
+		struct wrapper_codec : std::false_type
+		{};
+
+		/**
+		 * @brief Which of the wrapper overloads archive A takes for W. The archive is only inspected for wrappers; doing
+		 * so for BinaryData itself would recurse into is_binary_output.
+		 */
+		template < typename A, typename W, bool = wrapper_codec< W >::value >
+		struct wrapper_dispatch
+		{
+			static constexpr bool binary_output = false;
+			static constexpr bool binary_input = false;
+			static constexpr bool text_output = false;
+			static constexpr bool text_input = false;
+		};
+
+		template < typename A, typename W >
+		struct wrapper_dispatch< A, W, true >
+		{
+			static constexpr bool binary_output = is_binary_output< A >::value;
+			static constexpr bool binary_input = is_binary_input< A >::value;
+			static constexpr bool text_output = !binary_output;
+			static constexpr bool text_input = !binary_input;
+		};
+	}
+
+	template < typename A, typename W >
+	inline typename std::enable_if< ue4::wrapper_dispatch< A, W >::binary_output >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& ar, W const& in)
+	{
+		ue4::wrapper_codec< W >::save(ar, in);
+	}
+
+	template < typename A, typename W >
+	inline typename std::enable_if< ue4::wrapper_dispatch< A, W >::binary_input >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& ar, W& out)
+	{
+		ue4::wrapper_codec< W >::load(ar, out);
+	}
+
+	template < typename A, typename W >
+	inline typename std::enable_if< ue4::wrapper_dispatch< A, W >::text_output >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& ar, W const& in)
+	{
+		ue4::save_inline(ar, in.value);
+	}
+
+	template < typename A, typename W >
+	inline typename std::enable_if< ue4::wrapper_dispatch< A, W >::text_input >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& ar, W& out)
+	{
+		ue4::load_inline(ar, out.value);
+	}
+
+	/**
+	 * @brief Precision of the quantized encoding selected with make_quantized. The same settings must be used to save
+	 * and to load a field; they are not written to the archive.
+	 *
+	 * Error bounds, per component:
+	 * - Rotation is stored smallest-three: the index of the largest quaternion component in 2 bits, and the other
+	 *   three in RotationBits each, over [-1/sqrt(2), 1/sqrt(2)]. That is 32 bits for RotationBits = 10 and 47 bits,
+	 *   stored in 48, for RotationBits = 15. The three stored components are off by at most
+	 *   1 / (sqrt(2) * (2^RotationBits - 1)), about 6.9e-4 for 10 bits and 2.2e-5 for 15 bits, and the reconstructed
+	 *   largest component by up to about 2.5 times that. The decoded rotation stays within 0.25 degrees of the original
+	 *   for 10 bits and within 0.008 degrees for 15 bits.
+	 * - Translation and scale are fixed point with a step of TranslationStep and ScaleStep, so the error is at most
+	 *   half a step. Each component is a zig-zag varint of value / step, one byte for values within 64 steps of zero.
+	 * - TArray<FVector> and TArray<FVector2D> ignore the settings: each component is 16-bit fixed point over the
+	 *   array's bounds, so the error is half a step, 1/131070 of the bounds' extent on that axis, plus float rounding.
+	 *   Components must be finite.
+	 */
+	struct QuantizationSettings
+	{
+		/** Bits per stored quaternion component, 10 to 15. */
+		uint8 RotationBits = 15;
+		/** Fixed point resolution of translations, in world units. */
+		float TranslationStep = 0.01f;
+		/** Fixed point resolution of scales. */
+		float ScaleStep = 1.0f / 1024;
+	};
+
+	/**
+	 * @brief Wrapper selecting the quantized binary encoding for an FQuat, FVector (as a translation), FTransform,
+	 * TArray<FVector> or TArray<FVector2D>. Create with make_quantized. Text archives serialize the wrapped value
+	 * unquantized and exactly as if it were not wrapped.
+	 */
+	template < typename T >
+	struct Quantized
+	{
+		T value;
+		QuantizationSettings settings;
+	};
+
+	/**
+	 * @brief Serializes v with the quantized encoding described by settings.
+	 */
+	template < typename T >
+	inline Quantized< T > make_quantized(T&& v, QuantizationSettings const& settings = QuantizationSettings())
+	{
+		return { std::forward< T >(v), settings };
+	}
+
+	namespace ue4
+	{
+		inline void check_rotation_bits(QuantizationSettings const& settings)
+		{
+			if (settings.RotationBits < 10 || settings.RotationBits > 15)
+			{
+				throw Exception("QuantizationSettings::RotationBits must be between 10 and 15");
+			}
+		}
+
+		/**
+		 * @brief Packs a rotation as smallest-three: the largest component's index in the top two bits, followed by the
+		 * other three components, each scaled from [-1/sqrt(2), 1/sqrt(2)] to bits wide unsigned integers.
+		 */
+		inline uint64 pack_smallest_three(FQuat const& q, uint32 const bits)
+		{
+			float c[4] = { static_cast<float>(q.X), static_cast<float>(q.Y), static_cast<float>(q.Z), static_cast<float>(q.W) };
+			float const length = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2] + c[3] * c[3]);
+			if (length <= 0.0f)
+			{
+				c[0] = c[1] = c[2] = 0.0f;
+				c[3] = 1.0f;
+			}
+
+			uint32 largest = 0;
+			for (uint32 i = 1; i < 4; ++i)
+			{
+				if (std::fabs(c[i]) > std::fabs(c[largest]))
+				{
+					largest = i;
+				}
+			}
+
+			// q and -q are the same rotation, so flip the sign to make the dropped component positive.
+			float const scale = (c[largest] < 0.0f ? -1.0f : 1.0f) / (length > 0.0f ? length : 1.0f);
+			float const maximum = static_cast<float>((1u << bits) - 1);
+			uint64 packed = largest;
+			for (uint32 i = 0; i < 4; ++i)
+			{
+				if (i != largest)
+				{
+					float const unit = (c[i] * scale * 1.41421356f + 1.0f) * 0.5f;
+					float const clamped = std::min(std::max(unit, 0.0f), 1.0f);
+					packed = (packed << bits) | static_cast<uint64>(std::lround(clamped * maximum));
+				}
+			}
+			return packed;
+		}
+
+		inline FQuat unpack_smallest_three(uint64 packed, uint32 const bits)
+		{
+			uint32 const largest = static_cast<uint32>(packed >> (3 * bits)) & 3;
+			uint64 const mask = (static_cast<uint64>(1) << bits) - 1;
+			float const maximum = static_cast<float>(mask);
+			float c[4];
+			float sum = 0.0f;
+			for (int32 i = 3; i >= 0; --i)
+			{
+				if (static_cast<uint32>(i) != largest)
+				{
+					c[i] = (static_cast<float>(packed & mask) / maximum * 2.0f - 1.0f) * 0.70710678f;
+					sum += c[i] * c[i];
+					packed >>= bits;
+				}
+			}
+			c[largest] = std::sqrt(std::max(1.0f - sum, 0.0f));
+			return FQuat(c[0], c[1], c[2], c[3]);
+		}
+
+		/**
+		 * @brief Writes the low bytes of v, least significant first, so the result is independent of endianness.
+		 */
+		template < typename A >
+		inline void save_packed(A& ar, uint64 const v, std::size_t const bytes)
+		{
+			uint8 buffer[8];
+			for (std::size_t i = 0; i < bytes; ++i)
+			{
+				buffer[i] = static_cast<uint8>(v >> (8 * i));
+			}
+			ar(binary_data(static_cast<uint8 const*>(buffer), bytes));
+		}
+
+		template < typename A >
+		inline uint64 load_packed(A& ar, std::size_t const bytes)
+		{
+			uint8 buffer[8];
+			ar(binary_data(static_cast<uint8*>(buffer), bytes));
+			uint64 v = 0;
+			for (std::size_t i = 0; i < bytes; ++i)
+			{
+				v |= static_cast<uint64>(buffer[i]) << (8 * i);
+			}
+			return v;
+		}
+
+		inline std::size_t smallest_three_bytes(uint32 const bits)
+		{
+			return (2 + 3 * bits + 7) / 8;
+		}
+
+		template < typename A >
+		inline void save_fixed(A& ar, FVector const& v, float const step)
+		{
+			save_varint(ar, zigzag_encode(std::llround(v.X / step)));
+			save_varint(ar, zigzag_encode(std::llround(v.Y / step)));
+			save_varint(ar, zigzag_encode(std::llround(v.Z / step)));
+		}
+
+		template < typename A >
+		inline FVector load_fixed(A& ar, float const step)
+		{
+			double const x = static_cast<double>(zigzag_decode(load_varint(ar))) * step;
+			double const y = static_cast<double>(zigzag_decode(load_varint(ar))) * step;
+			double const z = static_cast<double>(zigzag_decode(load_varint(ar))) * step;
+			return FVector(x, y, z);
+		}
+
+		template < typename A >
+		inline void save_quantized(A& ar, FQuat const& q, QuantizationSettings const& settings)
+		{
+			check_rotation_bits(settings);
+			save_packed(ar, pack_smallest_three(q, settings.RotationBits), smallest_three_bytes(settings.RotationBits));
+		}
+
+		template < typename A >
+		inline void load_quantized(A& ar, FQuat& q, QuantizationSettings const& settings)
+		{
+			check_rotation_bits(settings);
+			q = unpack_smallest_three(load_packed(ar, smallest_three_bytes(settings.RotationBits)), settings.RotationBits);
+		}
+
+		template < typename A >
+		inline void save_quantized(A& ar, FVector const& v, QuantizationSettings const& settings)
+		{
+			save_fixed(ar, v, settings.TranslationStep);
+		}
+
+		template < typename A >
+		inline void load_quantized(A& ar, FVector& v, QuantizationSettings const& settings)
+		{
+			v = load_fixed(ar, settings.TranslationStep);
+		}
+
+		template < typename A >
+		inline void save_quantized(A& ar, FTransform const& t, QuantizationSettings const& settings)
+		{
+			transform_block block;
+			store_transform(t, block);
+			uint8 const mask = non_default_components(block);
+
+			ar(mask);
+			if (mask & transform_rotation)
+			{
+				save_quantized(ar, FQuat(block.Rotation[0], block.Rotation[1], block.Rotation[2], block.Rotation[3]), settings);
+			}
+			if (mask & transform_scale)
+			{
+				save_fixed(ar, FVector(block.Scale3D[0], block.Scale3D[1], block.Scale3D[2]), settings.ScaleStep);
+			}
+			if (mask & transform_translation)
+			{
+				save_fixed(ar, FVector(block.Translation[0], block.Translation[1], block.Translation[2]), settings.TranslationStep);
+			}
+		}
+
+		template < typename A >
+		inline void load_quantized(A& ar, FTransform& t, QuantizationSettings const& settings)
+		{
+			uint8 mask;
+			ar(mask);
+
+			FQuat rotation = FQuat::Identity;
+			FVector scale = FVector::OneVector;
+			FVector translation = FVector::ZeroVector;
+			if (mask & transform_rotation)
+			{
+				load_quantized(ar, rotation, settings);
+			}
+			if (mask & transform_scale)
+			{
+				scale = load_fixed(ar, settings.ScaleStep);
+			}
+			if (mask & transform_translation)
+			{
+				translation = load_fixed(ar, settings.TranslationStep);
+			}
+			t = FTransform(rotation, translation, scale);
+		}
+
+		/**
+		 * @brief Floats covered by one vector_quantization pattern: a multiple of the 2 and 3 component vector strides
+		 * and of the 8 lanes of an AVX register, so every SIMD block starts on the same component.
+		 */
+		constexpr std::size_t vector_lanes = 24;
+
+		/**
+		 * @brief Per-lane parameters for 16-bit fixed point vector components over the bounds Min to Max.
+		 */
+		struct vector_quantization
+		{
+			alignas(32) float Offset[vector_lanes];
+			alignas(32) float Scale[vector_lanes];
+			alignas(32) float Step[vector_lanes];
+
+			vector_quantization(float const* minimum, float const* maximum, std::size_t const components)
+			{
+				for (std::size_t lane = 0; lane < vector_lanes; ++lane)
+				{
+					std::size_t const c = lane % components;
+					float const extent = maximum[c] - minimum[c];
+					Offset[lane] = minimum[c];
+					Scale[lane] = extent > 0.0f ? 65535.0f / extent : 0.0f;
+					Step[lane] = extent > 0.0f ? extent / 65535.0f : 0.0f;
+				}
+			}
+		};
+
+		// Rounds relative to 32768 exactly as the SIMD kernels do, so every build writes the same bits.
+		inline uint16 quantize_component(float const v, float const offset, float const scale)
+		{
+			float const t = std::min(std::max(0.0f, (v - offset) * scale), 65535.0f);
+			return static_cast<uint16>(static_cast<int32>(std::nearbyint(t - 32768.0f)) + 32768);
+		}
+
+		inline float dequantize_component(uint16 const v, float const offset, float const step)
+		{
+			return static_cast<float>(v) * step + offset;
+		}
+
+#if CEREAL_UE4_SIMD >= 2
+		inline void quantize_components8(float const* in, uint16* out, float const* offset, float const* scale)
+		{
+			__m256 t = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(in), _mm256_load_ps(offset)), _mm256_load_ps(scale));
+			t = _mm256_min_ps(_mm256_max_ps(t, _mm256_setzero_ps()), _mm256_set1_ps(65535.0f));
+			__m256i const q = _mm256_cvtps_epi32(_mm256_sub_ps(t, _mm256_set1_ps(32768.0f)));
+			__m128i const packed = _mm_packs_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_xor_si128(packed, _mm_set1_epi16(static_cast<short>(0x8000))));
+		}
+
+		inline void dequantize_components8(uint16 const* in, float* out, float const* offset, float const* step)
+		{
+			__m256 const q = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in))));
+			_mm256_storeu_ps(out, _mm256_add_ps(_mm256_mul_ps(q, _mm256_load_ps(step)), _mm256_load_ps(offset)));
+		}
+#elif CEREAL_UE4_SIMD >= 1
+		inline __m128i quantize_components4(float const* in, float const* offset, float const* scale)
+		{
+			__m128 t = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(in), _mm_load_ps(offset)), _mm_load_ps(scale));
+			t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(65535.0f));
+			return _mm_cvtps_epi32(_mm_sub_ps(t, _mm_set1_ps(32768.0f)));
+		}
+
+		inline void quantize_components8(float const* in, uint16* out, float const* offset, float const* scale)
+		{
+			__m128i const packed = _mm_packs_epi32(quantize_components4(in, offset, scale), quantize_components4(in + 4, offset + 4, scale + 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_xor_si128(packed, _mm_set1_epi16(static_cast<short>(0x8000))));
+		}
+
+		inline void dequantize_components8(uint16 const* in, float* out, float const* offset, float const* step)
+		{
+			__m128i const q = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in));
+			__m128 const low = _mm_cvtepi32_ps(_mm_unpacklo_epi16(q, _mm_setzero_si128()));
+			__m128 const high = _mm_cvtepi32_ps(_mm_unpackhi_epi16(q, _mm_setzero_si128()));
+			_mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(low, _mm_load_ps(step)), _mm_load_ps(offset)));
+			_mm_storeu_ps(out + 4, _mm_add_ps(_mm_mul_ps(high, _mm_load_ps(step + 4)), _mm_load_ps(offset + 4)));
+		}
+#endif
+
+		/**
+		 * @brief Quantizes n vector components, in[0] being on lane 0 of the pattern.
+		 */
+		inline void quantize_components(float const* in, uint16* out, std::size_t const n, vector_quantization const& q)
+		{
+			std::size_t i = 0;
+#if CEREAL_UE4_SIMD
+			for (; i + vector_lanes <= n; i += vector_lanes)
+			{
+				for (std::size_t lane = 0; lane < vector_lanes; lane += 8)
+				{
+					quantize_components8(in + i + lane, out + i + lane, q.Offset + lane, q.Scale + lane);
+				}
+			}
+#endif
+			for (; i < n; ++i)
+			{
+				out[i] = quantize_component(in[i], q.Offset[i % vector_lanes], q.Scale[i % vector_lanes]);
+			}
+		}
+
+		/**
+		 * @brief Expands n quantized components back to floats. Runs from the last component to the first, so in may be
+		 * the start of out's own storage and arrays decode in place.
+		 */
+		inline void dequantize_components(uint16 const* in, float* out, std::size_t const n, vector_quantization const& q)
+		{
+			std::size_t const blocks = n - n % vector_lanes;
+			for (std::size_t i = n; i-- > blocks;)
+			{
+				out[i] = dequantize_component(in[i], q.Offset[i % vector_lanes], q.Step[i % vector_lanes]);
+			}
+			for (std::size_t i = blocks; i > 0;)
+			{
+				i -= vector_lanes;
+#if CEREAL_UE4_SIMD
+				for (std::size_t lane = vector_lanes; lane > 0;)
+				{
+					lane -= 8;
+					dequantize_components8(in + i + lane, out + i + lane, q.Offset + lane, q.Step + lane);
+				}
+#else
+				for (std::size_t lane = vector_lanes; lane-- > 0;)
+				{
+					out[i + lane] = dequantize_component(in[i + lane], q.Offset[lane], q.Step[lane]);
+				}
+#endif
+			}
+		}
+
+		/**
+		 * @brief Writes count vectors of the given number of float components: their bounds, then each component as the
+		 * 16-bit difference from the same component of the previous vector. Neighbouring points in spatially coherent
+		 * arrays give small differences that compress well. Converts through a fixed stack buffer.
+		 */
+		template < typename A >
+		inline void save_quantized_vectors(A& ar, float const* in, std::size_t const count, std::size_t const components)
+		{
+			ar(make_size_tag(static_cast<size_type>(count)));
+			if (count == 0)
+			{
+				return;
+			}
+
+			std::size_t const n = count * components;
+			float bounds[6];
+			float* const minimum = bounds;
+			float* const maximum = bounds + components;
+			for (std::size_t c = 0; c < components; ++c)
+			{
+				minimum[c] = maximum[c] = in[c];
+			}
+			for (std::size_t i = components; i < n; i += components)
+			{
+				for (std::size_t c = 0; c < components; ++c)
+				{
+					minimum[c] = std::min(minimum[c], in[i + c]);
+					maximum[c] = std::max(maximum[c], in[i + c]);
+				}
+			}
+			ar(binary_data(static_cast<float const*>(bounds), 2 * components * sizeof(float)));
+
+			vector_quantization const q(minimum, maximum, components);
+			std::size_t const batch = 128 * vector_lanes;
+			// The first components entries hold the previous batch's last vector, so differences carry across batches.
+			uint16 buffer[3 + batch] = {};
+			for (std::size_t first = 0; first < n; first += batch)
+			{
+				std::size_t const size = std::min(batch, n - first);
+				uint16* const values = buffer + components;
+				quantize_components(in + first, values, size, q);
+
+				uint16 last[3];
+				std::copy(values + size - components, values + size, last);
+				for (std::size_t i = size; i-- > 0;)
+				{
+					values[i] = static_cast<uint16>(values[i] - buffer[i]);
+				}
+				ar(binary_data(static_cast<uint16 const*>(values), size * sizeof(uint16)));
+				std::copy(last, last + components, buffer);
+			}
+		}
+
+		/**
+		 * @brief Reads what save_quantized_vectors wrote into the front of the array's own storage, sums the differences
+		 * and expands the components in place.
+		 */
+		template < typename A, typename E, typename L >
+		inline void load_quantized_vectors(A& ar, TArray< E, L >& out, std::size_t const components)
+		{
+			size_type count;
+			ar(make_size_tag(count));
+			out.SetNumUninitialized(static_cast<int32>(count), false);
+			if (count == 0)
+			{
+				return;
+			}
+
+			float bounds[6];
+			ar(binary_data(static_cast<float*>(bounds), 2 * components * sizeof(float)));
+
+			std::size_t const n = static_cast<std::size_t>(count) * components;
+			float* const data = reinterpret_cast<float*>(out.GetData());
+			uint16* const values = reinterpret_cast<uint16*>(data);
+			ar(binary_data(values, n * sizeof(uint16)));
+			for (std::size_t i = components; i < n; ++i)
+			{
+				values[i] = static_cast<uint16>(values[i] + values[i - components]);
+			}
+			dequantize_components(values, data, n, vector_quantization(bounds, bounds + components, components));
+		}
+
+		template < typename A, typename L >
+		inline void save_quantized(A& ar, TArray< FVector, L > const& in, QuantizationSettings const&)
+		{
+			save_quantized_vectors(ar, reinterpret_cast<float const*>(in.GetData()), static_cast<std::size_t>(in.Num()), 3);
+		}
+
+		template < typename A, typename L >
+		inline void load_quantized(A& ar, TArray< FVector, L >& out, QuantizationSettings const&)
+		{
+			load_quantized_vectors(ar, out, 3);
+		}
+
+		template < typename A, typename L >
+		inline void save_quantized(A& ar, TArray< FVector2D, L > const& in, QuantizationSettings const&)
+		{
+			static_assert(sizeof(FVector2D) == 2 * sizeof(float), "FVector2D is not a packed pair of floats");
+			save_quantized_vectors(ar, reinterpret_cast<float const*>(in.GetData()), static_cast<std::size_t>(in.Num()), 2);
+		}
+
+		template < typename A, typename L >
+		inline void load_quantized(A& ar, TArray< FVector2D, L >& out, QuantizationSettings const&)
+		{
+			load_quantized_vectors(ar, out, 2);
+		}
+	}
+
+	namespace ue4
+	{
+		template < typename T >
+		struct wrapper_codec< Quantized< T > > : std::true_type
+		{
+			template < typename A >
+			static void save(A& ar, Quantized< T > const& in)
+			{
+				save_quantized(ar, in.value, in.settings);
+			}
+
+			template < typename A >
+			static void load(A& ar, Quantized< T >& out)
+			{
+				load_quantized(ar, out.value, out.settings);
+			}
+		};
+	}
+
+	template <typename A>
+	inline typename std::enable_if< !ue4::is_binary_archive< A >::value >::type
+	serialize(A& ar, FString& str)
+	{
+		if (A::is_loading::value)
+		{
+			std::string temp;
+			ar(temp);
+			str = temp.c_str();
+		}
+		else
+		{
+			std::string temp(TCHAR_TO_UTF8(*str));
+			ar(temp);
+		}
+	}
+
+	namespace ue4
+	{
+		/** Set in an FString size tag when raw TCHAR code units follow. Bits 56 to 62 then hold sizeof(TCHAR). */
+		static const uint64 fstring_raw_tchar_flag = static_cast<uint64>(1) << 63;
+	}
+
+	// Binary archives write FString straight from its character buffer, as a size tag with the UTF-8 byte count followed
+	// by the bytes, identical to a std::string. ASCII strings, by far the most common, are narrowed and widened through
+	// the FString buffer itself without any temporary allocation. Loading also accepts the raw form of make_raw_tchars.
+	template <typename A>
+	inline typename std::enable_if< ue4::is_binary_output< A >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& ar, FString const& str)
+	{
+		std::size_t const length = static_cast<std::size_t>(str.Len());
+		TCHAR const* const chars = *str;
+
+		if (std::all_of(chars, chars + length, [](TCHAR const c) { return static_cast<uint32>(c) < 0x80; }))
+		{
+			ar(make_size_tag(static_cast<size_type>(length)));
+			ANSICHAR buffer[256];
+			for (std::size_t offset = 0; offset < length; offset += sizeof(buffer))
+			{
+				std::size_t const count = std::min(length - offset, sizeof(buffer));
+				std::transform(chars + offset, chars + offset + count, buffer, [](TCHAR const c) { return static_cast<ANSICHAR>(c); });
+				ar(binary_data(static_cast<ANSICHAR const*>(buffer), count));
+			}
+		}
+		else
+		{
+			FTCHARToUTF8 const converted(chars);
+			ar(make_size_tag(static_cast<size_type>(converted.Length())));
+			ar(binary_data(converted.Get(), static_cast<std::size_t>(converted.Length())));
+		}
+	}
+
+	template <typename A>
+	inline typename std::enable_if< ue4::is_binary_input< A >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& ar, FString& str)
+	{
+		size_type tag;
+		ar(make_size_tag(tag));
+
+		TArray<TCHAR>& chars = str.GetCharArray();
+		if (tag == 0)
+		{
+			chars.Reset();
+			return;
+		}
+
+		if (tag & ue4::fstring_raw_tchar_flag)
+		{
+			if (((tag >> 56) & 0x7F) != sizeof(TCHAR))
+			{
+				throw Exception("FString was saved as raw TCHAR of a different size");
+			}
+			int32 const length = static_cast<int32>(tag & ((static_cast<uint64>(1) << 56) - 1));
+			chars.SetNumUninitialized(length + 1, false);
+			ar(binary_data(chars.GetData(), static_cast<std::size_t>(length) * sizeof(TCHAR)));
+			chars[length] = 0;
+			return;
+		}
+
+		// Read the UTF-8 bytes into the front of the character buffer, then widen them in place from the back.
+		int32 const size = static_cast<int32>(tag);
+		chars.SetNumUninitialized(size + 1, false);
+		ANSICHAR* const bytes = reinterpret_cast<ANSICHAR*>(chars.GetData());
+		ar(binary_data(static_cast<ANSICHAR*>(bytes), static_cast<std::size_t>(size)));
+
+		if (std::all_of(bytes, bytes + size, [](ANSICHAR const c) { return static_cast<uint8>(c) < 0x80; }))
+		{
+			for (int32 i = size; i-- > 0;)
+			{
+				chars[i] = static_cast<TCHAR>(bytes[i]);
+			}
+			chars[size] = 0;
+		}
+		else
+		{
+			FUTF8ToTCHAR const converted(bytes, size);
+			str = FString(converted.Length(), converted.Get());
+		}
+	}
+
+	/**
+	 * @brief Wrapper that saves an FString to binary archives as its raw TCHAR code units instead of UTF-8, skipping
+	 * transcoding. Create with make_raw_tchars. Any FString field loads either form, but a raw string can only be
+	 * loaded where TCHAR has the same size. Text archives serialize the wrapped string unchanged.
+	 */
+	template < typename T >
+	struct RawTChars
+	{
+		T value;
+	};
+
+	/**
+	 * @brief Serializes the FString str as raw TCHAR code units.
+	 */
+	template < typename T >
+	inline RawTChars< T > make_raw_tchars(T&& str)
+	{
+		return { std::forward< T >(str) };
+	}
+
+	namespace ue4
+	{
+		template < typename T >
+		struct wrapper_codec< RawTChars< T > > : std::true_type
+		{
+			template < typename A >
+			static void save(A& ar, RawTChars< T > const& in)
+			{
+				FString const& str = in.value;
+				std::size_t const length = static_cast<std::size_t>(str.Len());
+				ar(make_size_tag(static_cast<size_type>(fstring_raw_tchar_flag | (static_cast<uint64>(sizeof(TCHAR)) << 56) | length)));
+				ar(binary_data(static_cast<TCHAR const*>(*str), length * sizeof(TCHAR)));
+			}
+
+			template < typename A >
+			static void load(A& ar, RawTChars< T >& out)
+			{
+				ar(out.value);
+			}
+		};
+	}
+
+	template <typename A>
+	inline typename std::enable_if< !ue4::is_compact_archive< A >::value >::type
+	serialize(A& ar, FText& str)
+	{
+		if (A::is_loading::value)
+		{
+			FString temp;
+			ar(temp);
+			str = FText::FromString(temp);
+		}
+		else
+		{
+			FString temp;
+			temp = str.ToString();
+			ar(temp);
+		}	
+	}
+
+	// Compact binary archives (see ue4::has_compact_format) keep a per archive table of localized texts, like the FName
+	// table below. A localized text is a
+	// varint reference, (id << 1) | isNew, followed the first time by its namespace, key and source string; any other
+	// text is a 0 followed by its display string. Ids are keyed on the shared display string, which the localization
+	// manager hands to every text with the same identity. Loading resolves each table entry once through FindText,
+	// so the result follows the live culture, and falls back to the source string when the entry is not found.
+	template <typename A>
+	inline typename std::enable_if< ue4::is_compact_output< A >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& ar, FText const& str)
+	{
+		FString const& display = FTextInspector::GetDisplayString(str);
+		TOptional<FString> const ns = FTextInspector::GetNamespace(str);
+		TOptional<FString> const key = FTextInspector::GetKey(str);
+		FString const* const source = FTextInspector::GetSourceString(str);
+		if (str.IsCultureInvariant() || !ns.IsSet() || !key.IsSet() || key.GetValue().IsEmpty() || !source)
+		{
+			ue4::save_varint(ar, 0);
+			ar(display);
+			return;
+		}
+
+		std::uint32_t const id = ar.registerSharedPointer(&display);
+		bool const isNew = (id & detail::msb_32bit) != 0;
+		ue4::save_varint(ar, (static_cast<uint64>(id & ~detail::msb_32bit) << 1) | (isNew ? 1 : 0));
+		if (isNew)
+		{
+			ar(ns.GetValue(), key.GetValue(), *source);
+		}
+	}
+
+	template <typename A>
+	inline typename std::enable_if< ue4::is_compact_input< A >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& ar, FText& str)
+	{
+		uint64 const reference = ue4::load_varint(ar);
+		if (reference == 0)
+		{
+			FString display;
+			ar(display);
+			str = FText::FromString(display);
+			return;
+		}
+
+		std::uint32_t const id = static_cast<std::uint32_t>(reference >> 1);
+		std::shared_ptr<void> entry;
+		if (reference & 1)
+		{
+			FString ns, key, source;
+			ar(ns, key, source);
+			auto text = std::make_shared<FText>();
+			if (!FText::FindText(ns, key, *text, &source))
+			{
+				*text = FText::FromString(source);
+			}
+			entry = text;
+			ar.registerSharedPointer(id, entry);
+		}
+		else
+		{
+			entry = ar.getSharedPointer(id);
+		}
+		str = *static_cast<FText const*>(entry.get());
+	}
+
+	template <typename A>
+	inline typename std::enable_if< !ue4::is_compact_archive< A >::value >::type
+	serialize(A& ar, FName& str)
+	{
+		if (A::is_loading::value)
+		{
+			FString temp;
+			ar(temp);
+			str = FName(*temp);
+		}
+		else
+		{
+			FString temp = str.ToString();
+			ar(temp);
+		}		
+	}
+
+	// Compact binary archives (see ue4::has_compact_format) keep a per archive name table. Each name is written as a varint reference, (id << 1) | isNew
+	// with 0 meaning NAME_None, followed by its plain string the first time the name entry is seen and by its number.
+	// Ids come from the archive's pointer tracking, keyed on the name's display entry, so they are unique per archive.
+	template <typename A>
+	inline typename std::enable_if< ue4::is_compact_output< A >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& ar, FName const& str)
+	{
+		if (str.IsNone())
+		{
+			ue4::save_varint(ar, 0);
+			return;
+		}
+
+		std::uint32_t const id = ar.registerSharedPointer(str.GetDisplayNameEntry());
+		bool const isNew = (id & detail::msb_32bit) != 0;
+		ue4::save_varint(ar, (static_cast<uint64>(id & ~detail::msb_32bit) << 1) | (isNew ? 1 : 0));
+		if (isNew)
+		{
+			ar(str.GetPlainNameString());
+		}
+		ue4::save_varint(ar, static_cast<uint32>(str.GetNumber()));
+	}
+
+	template <typename A>
+	inline typename std::enable_if< ue4::is_compact_input< A >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& ar, FName& str)
+	{
+		uint64 const reference = ue4::load_varint(ar);
+		if (reference == 0)
+		{
+			str = FName(NAME_None);
+			return;
+		}
+
+		std::uint32_t const id = static_cast<std::uint32_t>(reference >> 1);
+		std::shared_ptr<void> entry;
+		if (reference & 1)
+		{
+			FString plain;
+			ar(plain);
+			entry = std::make_shared<FName>(*plain, NAME_NO_NUMBER_INTERNAL);
+			ar.registerSharedPointer(id, entry);
+		}
+		else
+		{
+			entry = ar.getSharedPointer(id);
+		}
+		str = FName(*static_cast<FName const*>(entry.get()), static_cast<int32>(ue4::load_varint(ar)));
+	}
+
+	template < typename A >
+	inline void serialize(A& ar, FBox& in)
+	{
+		ar(make_nvp("IsValid", in.Max), make_nvp("Min", in.Min), make_nvp("Max", in.Max));
+	}
+
+	template < typename A >
+	inline void serialize(A& ar, FBox2D& in)
+	{
+		ar(make_nvp("bIsValid", in.Max), make_nvp("Min", in.Min), make_nvp("Max", in.Max));
+	}
+
+	template < typename A >
+	inline void serialize(A& ar, FCapsuleShape& in)
+	{
+		ar(make_nvp("Center", in.Center));
+		ar(make_nvp("Radius", in.Radius));
+		ar(make_nvp("Orientation", in.Orientation));
+		ar(make_nvp("Length", in.Length));
+	}
+
+	template < typename A >
+	inline typename std::enable_if< !ue4::is_binary_archive< A >::value >::type
+	serialize(A& ar, FColor& in)
+	{
+		ar(make_nvp("R", in.R), make_nvp("G", in.G), make_nvp("B", in.B), make_nvp("A", in.A));
+	}
+
+	/**
+	 * @brief Binary archives store an FColor as its R, G, B and A bytes in one binary_data call, the same bytes the
+	 * field-wise form writes and TArray<FColor> holds per color. Single bytes are never swapped, so portable archives
+	 * and archives with compact integers write them unchanged too.
+	 */
+	template < typename A >
+	inline typename std::enable_if< ue4::is_binary_output< A >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& ar, const FColor& in)
+	{
+		uint8 const rgba[4] = { in.R, in.G, in.B, in.A };
+		ar(binary_data(static_cast< uint8 const* >(rgba), sizeof(rgba)));
+	}
+
+	template < typename A >
+	inline typename std::enable_if< ue4::is_binary_input< A >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& ar, FColor& out)
+	{
+		uint8 rgba[4];
+		ar(binary_data(static_cast< uint8* >(rgba), sizeof(rgba)));
+		out = FColor(rgba[0], rgba[1], rgba[2], rgba[3]);
+	}
+
+	template < typename A >
+	inline typename std::enable_if< !ue4::is_compact_output< A >::value, std::string >::type
+	save_minimal(A& ar, const FDateTime& in)
+	{
+		return std::string(TCHAR_TO_UTF8(*in.ToIso8601()));
+	}
+
+	template < typename A >
+	inline typename std::enable_if< !ue4::is_compact_input< A >::value >::type
+	load_minimal(A& ar, FDateTime& out, const std::string& v)
+	{
+		FDateTime::ParseIso8601(UTF8_TO_TCHAR(v.data()), out);
+	}
+
+	template < typename A >
+	inline typename std::enable_if< ue4::is_compact_output< A >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& ar, const FDateTime& in)
+	{
+		int64 const ticks = in.GetTicks();
+		ue4::save_fixed(ar, ticks);
+	}
+
+	template < typename A >
+	inline typename std::enable_if< ue4::is_compact_input< A >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& ar, FDateTime& out)
+	{
+		int64 ticks;
+		ue4::load_fixed(ar, ticks);
+		out = FDateTime(ticks);
+	}
+
+	template < typename A >
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FIntPoint >::value >::type
+	serialize(A& a, FIntPoint& in)
+	{
+		a(make_nvp("X", in.X), make_nvp("Y", in.Y));
+	}
+
+	template < typename A >
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FIntRect >::value >::type
+	serialize(A& ar, FIntRect& in)
+	{
+		ar(make_nvp("Min", in.Min), make_nvp("Max", in.Max));
+	}
+
+	template < typename A >
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FIntVector >::value >::type
+	serialize(A& ar, FIntVector& in)
+	{
+		ar(make_nvp("X", in.X), make_nvp("Y", in.Y), make_nvp("Z", in.Z));
+	}
+
+	template < typename A >
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FIntVector4 >::value >::type
+	serialize(A& a, FIntVector4& in)
+	{
+		a(make_nvp("X", in.X), make_nvp("Y", in.Y), make_nvp("Z", in.Z), make_nvp("W", in.W));
+	}
+
+	template < typename A >
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FLinearColor >::value >::type
+	serialize(A& ar, FLinearColor& in)
+	{
+		ar(make_nvp("R", in.R), make_nvp("G", in.G), make_nvp("B", in.B), make_nvp("A", in.A));
+	}
+
+	/**
+	 * @brief Binary encodings of FLinearColor selectable with make_encoded_color. The same encoding must be used to save
+	 * and to load a field; it is not written to the archive.
+	 */
+	enum class ELinearColorEncoding : uint8
+	{
+		/** Four 32-bit floats, 16 bytes per color. Lossless. */
+		Float,
+		/**
+		 * Four IEEE 754 half precision floats, 8 bytes per color. Relative error at most 2^-11; magnitudes above 65504
+		 * become infinities. Builds with and without CEREAL_UE4_F16C write the same bits for every value but NaN: F16C
+		 * keeps the top of a NaN's payload, the scalar conversion writes a plain quiet NaN. Either way NaNs load as NaN.
+		 */
+		Half,
+		/**
+		 * Three 8-bit mantissas sharing an 8-bit exponent, 4 bytes per color. Each channel is within 1/256 of the
+		 * brightest one, negative channels become zero and alpha is dropped and loads as 1.
+		 */
+		RGBE
+	};
+
+	/**
+	 * @brief Wrapper selecting a compact binary encoding for an FLinearColor or a TArray of them. Create with
+	 * make_encoded_color. Text archives serialize the wrapped value unchanged.
+	 */
+	template < typename T >
+	struct EncodedColor
+	{
+		T value;
+		ELinearColorEncoding encoding;
+	};
+
+	/**
+	 * @brief Serializes v, an FLinearColor or TArray<FLinearColor>, with the given encoding.
+	 */
+	template < typename T >
+	inline EncodedColor< T > make_encoded_color(T&& v, ELinearColorEncoding const encoding)
+	{
+		return { std::forward< T >(v), encoding };
+	}
+
+	namespace ue4
+	{
+		/**
+		 * @brief Converts to IEEE 754 half precision, rounding to nearest even. NaNs become a quiet NaN of the same sign.
+		 */
+		inline uint16 float_to_half(float const value)
+		{
+			uint32 bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			uint16 const sign = static_cast<uint16>((bits >> 16) & 0x8000);
+			uint32 const magnitude = bits & 0x7fffffff;
+
+			if (magnitude > 0x7f800000)
+			{
+				return sign | 0x7e00;
+			}
+			if (magnitude >= 0x477ff000)
+			{
+				// 65520 and up round past the largest half.
+				return sign | 0x7c00;
+			}
+			if (magnitude < 0x33000000)
+			{
+				return sign;
+			}
+
+			uint32 const exponent = magnitude >> 23;
+			uint32 const mantissa = (magnitude & 0x7fffff) | 0x800000;
+			uint32 shift;
+			uint32 half;
+			if (exponent < 113)
+			{
+				// Subnormal half, counting in units of 2^-24.
+				shift = 126 - exponent;
+				half = mantissa >> shift;
+			}
+			else
+			{
+				shift = 13;
+				half = ((exponent - 112) << 10) | ((mantissa & 0x7fffff) >> 13);
+			}
+
+			uint32 const rest = mantissa & ((1u << shift) - 1);
+			uint32 const midpoint = 1u << (shift - 1);
+			if (rest > midpoint || (rest == midpoint && (half & 1)))
+			{
+				++half;
+			}
+			return sign | static_cast<uint16>(half);
+		}
+
+		inline float half_to_float(uint16 const half)
+		{
+			uint32 const sign = static_cast<uint32>(half & 0x8000) << 16;
+			uint32 const exponent = (half >> 10) & 0x1f;
+			uint32 const mantissa = half & 0x3ff;
+
+			if (exponent == 0)
+			{
+				float const value = std::ldexp(static_cast<float>(mantissa), -24);
+				return sign ? -value : value;
+			}
+
+			uint32 const bits = sign | (exponent == 0x1f ? 0x7f800000 : (exponent + 112) << 23) | (mantissa << 13);
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		inline void encode_half(FLinearColor const* in, uint16* out, std::size_t const count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+#if CEREAL_UE4_F16C
+				__m128i const packed = _mm_cvtps_ph(_mm_loadu_ps(&in[i].R), _MM_FROUND_TO_NEAREST_INT);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(out + 4 * i), packed);
+#else
+				out[4 * i + 0] = float_to_half(in[i].R);
+				out[4 * i + 1] = float_to_half(in[i].G);
+				out[4 * i + 2] = float_to_half(in[i].B);
+				out[4 * i + 3] = float_to_half(in[i].A);
+#endif
+			}
+		}
+
+		/**
+		 * @brief Converts count half precision colors back to floats. Runs from the last color to the first, so in may be
+		 * the start of out's own storage and arrays decode in place.
+		 */
+		inline void decode_half(uint16 const* in, FLinearColor* out, std::size_t const count)
+		{
+			for (std::size_t i = count; i-- > 0;)
+			{
+#if CEREAL_UE4_F16C
+				__m128 const color = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(in + 4 * i)));
+				_mm_storeu_ps(&out[i].R, color);
+#else
+				float const r = half_to_float(in[4 * i + 0]);
+				float const g = half_to_float(in[4 * i + 1]);
+				float const b = half_to_float(in[4 * i + 2]);
+				float const a = half_to_float(in[4 * i + 3]);
+				out[i] = FLinearColor(r, g, b, a);
+#endif
+			}
+		}
+
+		inline void encode_rgbe(FLinearColor const* in, uint8* out, std::size_t const count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				FLinearColor const& c = in[i];
+				uint8* const rgbe = out + 4 * i;
+				float const primary = std::min(std::max(std::max(c.R, c.G), c.B), std::numeric_limits<float>::max());
+				if (!(primary >= 1e-32f))
+				{
+					rgbe[0] = rgbe[1] = rgbe[2] = rgbe[3] = 0;
+					continue;
+				}
+
+				int exponent;
+				float const scale = std::frexp(primary, &exponent) * 256.0f / primary;
+				rgbe[0] = static_cast<uint8>(std::min(std::max(0.0f, c.R * scale), 255.0f));
+				rgbe[1] = static_cast<uint8>(std::min(std::max(0.0f, c.G * scale), 255.0f));
+				rgbe[2] = static_cast<uint8>(std::min(std::max(0.0f, c.B * scale), 255.0f));
+				rgbe[3] = static_cast<uint8>(std::min(exponent + 128, 255));
+			}
+		}
+
+		/**
+		 * @brief Converts count RGBE colors back to floats, decoding each mantissa to the middle of its step. Like
+		 * decode_half, it runs backwards so arrays can decode in place.
+		 */
+		inline void decode_rgbe(uint8 const* in, FLinearColor* out, std::size_t const count)
+		{
+			for (std::size_t i = count; i-- > 0;)
+			{
+				uint8 const* const rgbe = in + 4 * i;
+				if (rgbe[3] == 0)
+				{
+					out[i] = FLinearColor(0.0f, 0.0f, 0.0f, 1.0f);
+					continue;
+				}
+
+				float const scale = std::ldexp(1.0f, static_cast<int>(rgbe[3]) - (128 + 8));
+				float const r = (rgbe[0] + 0.5f) * scale;
+				float const g = (rgbe[1] + 0.5f) * scale;
+				float const b = (rgbe[2] + 0.5f) * scale;
+				out[i] = FLinearColor(r, g, b, 1.0f);
+			}
+		}
+
+		/**
+		 * @brief Writes count colors as one block of the given encoding, converting through a fixed stack buffer so
+		 * large arrays need no temporary allocation.
+		 */
+		template < typename A >
+		inline void save_colors(A& ar, FLinearColor const* in, std::size_t const count, ELinearColorEncoding const encoding)
+		{
+			std::size_t const batch = 256;
+			switch (encoding)
+			{
+			case ELinearColorEncoding::Float:
+				ar(binary_data(reinterpret_cast<float const*>(in), count * sizeof(FLinearColor)));
+				return;
+			case ELinearColorEncoding::Half:
+				for (std::size_t first = 0; first < count; first += batch)
+				{
+					uint16 buffer[4 * batch];
+					std::size_t const n = std::min(batch, count - first);
+					encode_half(in + first, buffer, n);
+					ar(binary_data(static_cast<uint16 const*>(buffer), n * 4 * sizeof(uint16)));
+				}
+				return;
+			case ELinearColorEncoding::RGBE:
+				for (std::size_t first = 0; first < count; first += batch)
+				{
+					uint8 buffer[4 * batch];
+					std::size_t const n = std::min(batch, count - first);
+					encode_rgbe(in + first, buffer, n);
+					ar(binary_data(static_cast<uint8 const*>(buffer), n * 4));
+				}
+				return;
+			}
+			throw Exception("Unknown ELinearColorEncoding");
+		}
+
+		/**
+		 * @brief Reads count colors of the given encoding. Compact encodings are read into the front of out and
+		 * expanded in place.
+		 */
+		template < typename A >
+		inline void load_colors(A& ar, FLinearColor* out, std::size_t const count, ELinearColorEncoding const encoding)
+		{
+			switch (encoding)
+			{
+			case ELinearColorEncoding::Float:
+				ar(binary_data(reinterpret_cast<float*>(out), count * sizeof(FLinearColor)));
+				return;
+			case ELinearColorEncoding::Half:
+				ar(binary_data(reinterpret_cast<uint16*>(out), count * 4 * sizeof(uint16)));
+				decode_half(reinterpret_cast<uint16 const*>(out), out, count);
+				return;
+			case ELinearColorEncoding::RGBE:
+				ar(binary_data(reinterpret_cast<uint8*>(out), count * 4));
+				decode_rgbe(reinterpret_cast<uint8 const*>(out), out, count);
+				return;
+			}
+			throw Exception("Unknown ELinearColorEncoding");
+		}
+
+		template < typename A >
+		inline void save_encoded(A& ar, FLinearColor const& in, ELinearColorEncoding const encoding)
+		{
+			save_colors(ar, &in, 1, encoding);
+		}
 
-	template < typename A >
-    inline void load_minimal(A& ar, FDateTime& out, const std::string& v)
-	{
-		FDateTime::ParseIso8601(UTF8_TO_TCHAR(v.data()), out);
-	}
+		template < typename A >
+		inline void load_encoded(A& ar, FLinearColor& out, ELinearColorEncoding const encoding)
+		{
+			load_colors(ar, &out, 1, encoding);
+		}
 
-	template < typename A >
-	inline void serialize(A& a, FIntPoint& in)
-	{
-		a(make_nvp("X", in.X), make_nvp("Y", in.Y));
-	}
+		template < typename A, typename L >
+		inline void save_encoded(A& ar, TArray< FLinearColor, L > const& in, ELinearColorEncoding const encoding)
+		{
+			ar(make_size_tag(static_cast<size_type>(in.Num())));
+			save_colors(ar, in.GetData(), static_cast<std::size_t>(in.Num()), encoding);
+		}
 
-	template < typename A >
-	inline void serialize(A& ar, FIntRect& in)
-	{
-		ar(make_nvp("Min", in.Min), make_nvp("Max", in.Max));
-	}
+		template < typename A, typename L >
+		inline void load_encoded(A& ar, TArray< FLinearColor, L >& out, ELinearColorEncoding const encoding)
+		{
+			size_type size;
+			ar(make_size_tag(size));
 
-	template < typename A >
-	inline void serialize(A& ar, FIntVector& in)
-	{
-		ar(make_nvp("X", in.X), make_nvp("Y", in.Y), make_nvp("Z", in.Z));
+			out.SetNumUninitialized(static_cast<int32>(size), false);
+			load_colors(ar, out.GetData(), static_cast<std::size_t>(size), encoding);
+		}
 	}
 
-	template < typename A >
-	inline void serialize(A& a, FIntVector4& in)
+	namespace ue4
 	{
-		a(make_nvp("X", in.X), make_nvp("Y", in.Y), make_nvp("Z", in.Z), make_nvp("W", in.W));
+		template < typename T >
+		struct wrapper_codec< EncodedColor< T > > : std::true_type
+		{
+			template < typename A >
+			static void save(A& ar, EncodedColor< T > const& in)
+			{
+				save_encoded(ar, in.value, in.encoding);
+			}
+
+			template < typename A >
+			static void load(A& ar, EncodedColor< T >& out)
+			{
+				load_encoded(ar, out.value, out.encoding);
+			}
+		};
 	}
 
+	// Binary archives move the whole matrix as one block, loading straight into FMatrix's 16-byte aligned storage.
 	template < typename A >
-	inline void serialize(A& ar, FLinearColor& in)
+	inline typename std::enable_if< ue4::is_binary_archive< A >::value >::type
+	serialize(A& ar, FMatrix& in)
 	{
-		ar(make_nvp("R", in.R), make_nvp("G", in.G), make_nvp("B", in.B), make_nvp("A", in.A));
+		ar(binary_data(&in.M[0][0], sizeof(in.M)));
 	}
 
 	template < typename A >
-	inline void serialize(A& ar, FMatrix& in)
+	inline typename std::enable_if< !ue4::is_binary_archive< A >::value >::type
+	serialize(A& ar, FMatrix& in)
 	{
 		ar(cereal::make_nvp("m00", in.M[0][0]));
 		ar(cereal::make_nvp("m01", in.M[0][1]));
@@ -324,6 +2584,76 @@ namespace cereal
 		ar(cereal::make_nvp("m33", in.M[3][3]));
 	}
 
+	/**
+	 * @brief Wrapper that serializes only the affine 4x3 part of an FMatrix, M[r][0..2] for every row r. The last
+	 * column is restored as (0, 0, 0, 1) on load. Create with make_affine_matrix.
+	 */
+	template < typename T >
+	struct AffineMatrix
+	{
+		T matrix;
+	};
+
+	/**
+	 * @brief Serializes m as an affine 4x3 matrix, saving a quarter of the space of a full FMatrix.
+	 */
+	template < typename T >
+	inline AffineMatrix< T > make_affine_matrix(T&& m)
+	{
+		return { std::forward< T >(m) };
+	}
+
+	namespace ue4
+	{
+		using matrix_element_type = typename std::remove_all_extents< decltype(FMatrix::M) >::type;
+
+		template < typename A >
+		inline typename std::enable_if< is_binary_archive< A >::value >::type
+		serialize_affine(A& ar, matrix_element_type (&values)[12])
+		{
+			ar(binary_data(static_cast< matrix_element_type* >(values), sizeof(values)));
+		}
+
+		template < typename A >
+		inline typename std::enable_if< !is_binary_archive< A >::value >::type
+		serialize_affine(A& ar, matrix_element_type (&values)[12])
+		{
+			ar(make_nvp("m00", values[0]), make_nvp("m01", values[1]), make_nvp("m02", values[2]));
+			ar(make_nvp("m10", values[3]), make_nvp("m11", values[4]), make_nvp("m12", values[5]));
+			ar(make_nvp("m20", values[6]), make_nvp("m21", values[7]), make_nvp("m22", values[8]));
+			ar(make_nvp("m30", values[9]), make_nvp("m31", values[10]), make_nvp("m32", values[11]));
+		}
+	}
+
+	template < typename A, typename T >
+	inline void CEREAL_SAVE_FUNCTION_NAME(A& ar, const AffineMatrix< T >& in)
+	{
+		ue4::matrix_element_type values[12];
+		for (int32 r = 0; r < 4; ++r)
+		{
+			for (int32 c = 0; c < 3; ++c)
+			{
+				values[r * 3 + c] = in.matrix.M[r][c];
+			}
+		}
+		ue4::serialize_affine(ar, values);
+	}
+
+	template < typename A, typename T >
+	inline void CEREAL_LOAD_FUNCTION_NAME(A& ar, AffineMatrix< T >& out)
+	{
+		ue4::matrix_element_type values[12];
+		ue4::serialize_affine(ar, values);
+		for (int32 r = 0; r < 4; ++r)
+		{
+			for (int32 c = 0; c < 3; ++c)
+			{
+				out.matrix.M[r][c] = values[r * 3 + c];
+			}
+			out.matrix.M[r][3] = r == 3 ? 1 : 0;
+		}
+	}
+
 	template < typename A >
 	inline void CEREAL_SAVE_FUNCTION_NAME(A& ar, const FMatrix2x2& in)
 	{
@@ -360,7 +2690,8 @@ namespace cereal
 	}
 
 	template < typename A >
-	inline void serialize(A& ar, FPlane& in)
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FPlane >::value >::type
+	serialize(A& ar, FPlane& in)
 	{
 		ar(make_nvp("X", in.X), make_nvp("Y", in.Y), make_nvp("Z", in.Z), make_nvp("W", in.W));
 	}
@@ -440,43 +2771,155 @@ namespace cereal
 	}
 
 	template < typename A >
-	inline void serialize(A& ar, FSphere& in)
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FSphere >::value >::type
+	serialize(A& ar, FSphere& in)
 	{
 		ar(make_nvp("Center", in.Center), make_nvp("W", in.W));
 	}
 
 	template < typename A >
-	inline std::string save_minimal(A& a, const FTimespan& in)
+	inline typename std::enable_if< !ue4::is_compact_output< A >::value, std::string >::type
+	save_minimal(A& a, const FTimespan& in)
 	{
 		return std::string(TCHAR_TO_UTF8(*in.ToString()));
 	}
 
 	template < typename A >
-    inline void load_minimal(A& a, FTimespan& out, const std::string& v)
+	inline typename std::enable_if< !ue4::is_compact_input< A >::value >::type
+	load_minimal(A& a, FTimespan& out, const std::string& v)
 	{
 		FTimespan::Parse(UTF8_TO_TCHAR(v.data()), out);
 	}
 
 	template < typename A >
-	inline void serialize(A& a, FTwoVectors& in)
+	inline typename std::enable_if< ue4::is_compact_output< A >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& a, const FTimespan& in)
+	{
+		int64 const ticks = in.GetTicks();
+		ue4::save_fixed(a, ticks);
+	}
+
+	template < typename A >
+	inline typename std::enable_if< ue4::is_compact_input< A >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& a, FTimespan& out)
+	{
+		int64 ticks;
+		ue4::load_fixed(a, ticks);
+		out = FTimespan(ticks);
+	}
+
+	template < typename A >
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FTwoVectors >::value >::type
+	serialize(A& a, FTwoVectors& in)
 	{
 		a(make_nvp("v1", in.v1), make_nvp("v2", in.v2));
 	}
 
 	template < typename A >
-	inline void serialize(A& a, FUintVector4& in)
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FUintVector4 >::value >::type
+	serialize(A& a, FUintVector4& in)
 	{
 		a(make_nvp("X", in.X), make_nvp("Y", in.Y), make_nvp("Z", in.Z), make_nvp("W", in.W));
 	}
 
 	template < typename A >
-	inline void serialize(A& a, FVector2D& in)
+	inline typename std::enable_if< !ue4::is_binary_blob< A, FVector2D >::value >::type
+	serialize(A& a, FVector2D& in)
 	{
 		a(make_nvp("X", in.X), make_nvp("Y", in.Y));
 	}
 
+	namespace ue4
+	{
+		/**
+		 * @brief True for TArray<FColor> in binary archives, which take the batched color path below. The archive is
+		 * only inspected for FColor arrays.
+		 */
+		template < typename A, typename E >
+		struct is_color_array_output : std::conditional< std::is_same< E, FColor >::value, is_binary_output< A >, std::false_type >::type
+		{};
+
+		template < typename A, typename E >
+		struct is_color_array_input : std::conditional< std::is_same< E, FColor >::value, is_binary_input< A >, std::false_type >::type
+		{};
+
+		/** Colors converted per batch of TArray<FColor>. */
+		constexpr int32 color_batch = 256;
+	}
+
+	/**
+	 * @brief Binary archives write every color of a TArray<FColor> as R, G, B, A bytes, the order single colors and
+	 * earlier saves use. FColor's memory order depends on the platform's endianness, so the array's storage is not
+	 * written directly; colors are reordered through a stack buffer, one archive call per batch.
+	 */
+	template < typename A, typename L >
+	inline typename std::enable_if< ue4::is_binary_output< A >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& a, const TArray< FColor, L >& in)
+	{
+		a(make_size_tag(static_cast<size_type>(in.Num())));
+
+		uint8 buffer[4 * ue4::color_batch];
+		for (int32 first = 0; first < in.Num(); first += ue4::color_batch)
+		{
+			int32 const count = std::min(in.Num() - first, ue4::color_batch);
+			for (int32 i = 0; i < count; ++i)
+			{
+				FColor const& c = in[first + i];
+				buffer[4 * i + 0] = c.R;
+				buffer[4 * i + 1] = c.G;
+				buffer[4 * i + 2] = c.B;
+				buffer[4 * i + 3] = c.A;
+			}
+			a(binary_data(static_cast< uint8* >(buffer), static_cast<std::size_t>(count) * 4));
+		}
+	}
+
+	// Loads the bytes straight into the array and reorders each color in place.
+	template < typename A, typename L >
+	inline typename std::enable_if< ue4::is_binary_input< A >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& a, TArray< FColor, L >& out)
+	{
+		static_assert(sizeof(FColor) == 4, "FColor is not four packed bytes");
+
+		size_type size;
+		a(make_size_tag(size));
+
+		out.SetNumUninitialized(static_cast<int32>(size), false);
+		uint8* const bytes = reinterpret_cast< uint8* >(out.GetData());
+		a(binary_data(static_cast< uint8* >(bytes), static_cast<std::size_t>(size) * 4));
+		for (int32 i = 0; i < out.Num(); ++i)
+		{
+			uint8 const* const rgba = bytes + 4 * i;
+			out[i] = FColor(rgba[0], rgba[1], rgba[2], rgba[3]);
+		}
+	}
+
+	template < typename A, typename E, typename L >
+	inline typename std::enable_if< ue4::is_binary_block_output< A, E >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& a, const TArray< E, L >& in)
+	{
+		using T = typename ue4::binary_block_traits< E >::element_type;
+
+		a(make_size_tag(static_cast<size_type>(in.Num())));
+		a(binary_data(reinterpret_cast< const T* >(in.GetData()), static_cast<std::size_t>(in.Num()) * sizeof(E)));
+	}
+
+	template < typename A, typename E, typename L >
+	inline typename std::enable_if< ue4::is_binary_block_input< A, E >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& a, TArray< E, L >& out)
+	{
+		using T = typename ue4::binary_block_traits< E >::element_type;
+
+		size_type size;
+		a(make_size_tag(size));
+
+		out.SetNumUninitialized(static_cast<int32>(size), false);
+		a(binary_data(reinterpret_cast< T* >(out.GetData()), static_cast<std::size_t>(size) * sizeof(E)));
+	}
+
 	template < typename A, typename E, typename L >
-	inline void CEREAL_SAVE_FUNCTION_NAME(A& a, const TArray<E, L>& in)
+	inline typename std::enable_if< !ue4::is_binary_block_output< A, E >::value && !ue4::is_color_array_output< A, E >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(A& a, const TArray<E, L>& in)
 	{
 		a(make_size_tag(static_cast<size_type>(in.Num())));
 		for (auto&& e : in)
@@ -486,34 +2929,175 @@ namespace cereal
 	}
 
 	template < typename A, typename E, typename L >
-    inline void CEREAL_LOAD_FUNCTION_NAME(A& a, TArray< E, L >& out)
+	inline typename std::enable_if< !ue4::is_binary_block_input< A, E >::value && !ue4::is_color_array_input< A, E >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(A& a, TArray< E, L >& out)
 	{
 		size_type size;
 		a(make_size_tag(size));
 
-		out.SetNum(static_cast<int32>(size));
-		for (auto&& e : out)
+		out.Reset(static_cast<int32>(size));
+		for (size_type i = 0; i < size; ++i)
 		{
-			a(e);
+			ue4::load_emplace(a, out);
+		}
+	}
+
+	/**
+	 * @brief Wrapper selecting the columnar binary encoding for a TArray of FVector, FRotator or FQuat: the size, then
+	 * every element's first component, then every element's second and so on, in memory order. Columns of like values
+	 * compress far better than interleaved components. Create with make_columnar. Text archives serialize the wrapped
+	 * array unchanged.
+	 */
+	template < typename T >
+	struct Columnar
+	{
+		T value;
+	};
+
+	/**
+	 * @brief Serializes the array v in columns.
+	 */
+	template < typename T >
+	inline Columnar< T > make_columnar(T&& v)
+	{
+		return { std::forward< T >(v) };
+	}
+
+	namespace ue4
+	{
+		/**
+		 * @brief Number of float components of types that make_columnar accepts.
+		 */
+		template < typename T >
+		struct columnar_traits;
+
+		template <>
+		struct columnar_traits< FVector > : std::integral_constant< std::size_t, 3 >
+		{};
+
+		template <>
+		struct columnar_traits< FRotator > : std::integral_constant< std::size_t, 3 >
+		{};
+
+		template <>
+		struct columnar_traits< FQuat > : std::integral_constant< std::size_t, 4 >
+		{};
+
+		/**
+		 * @brief Writes in column by column, gathering each column through a fixed stack buffer.
+		 */
+		template < typename A, typename E, typename L >
+		inline void save_columnar(A& a, TArray< E, L > const& in)
+		{
+			std::size_t const components = columnar_traits< E >::value;
+			static_assert(sizeof(E) == columnar_traits< E >::value * sizeof(float), "Columnar elements must be packed floats");
+
+			std::size_t const count = static_cast<std::size_t>(in.Num());
+			a(make_size_tag(static_cast<size_type>(count)));
+
+			float const* const data = reinterpret_cast<float const*>(in.GetData());
+			std::size_t const batch = 1024;
+			float buffer[batch];
+			for (std::size_t c = 0; c < components; ++c)
+			{
+				for (std::size_t first = 0; first < count; first += batch)
+				{
+					std::size_t const size = std::min(batch, count - first);
+					for (std::size_t i = 0; i < size; ++i)
+					{
+						buffer[i] = data[(first + i) * components + c];
+					}
+					a(binary_data(static_cast<float const*>(buffer), size * sizeof(float)));
+				}
+			}
+		}
+
+		/**
+		 * @brief Reads out column by column, scattering each column into the elements through a fixed stack buffer.
+		 */
+		template < typename A, typename E, typename L >
+		inline void load_columnar(A& a, TArray< E, L >& out)
+		{
+			std::size_t const components = columnar_traits< E >::value;
+			static_assert(sizeof(E) == columnar_traits< E >::value * sizeof(float), "Columnar elements must be packed floats");
+
+			size_type size;
+			a(make_size_tag(size));
+			std::size_t const count = static_cast<std::size_t>(size);
+			out.SetNumUninitialized(static_cast<int32>(count), false);
+
+			float* const data = reinterpret_cast<float*>(out.GetData());
+			std::size_t const batch = 1024;
+			float buffer[batch];
+			for (std::size_t c = 0; c < components; ++c)
+			{
+				for (std::size_t first = 0; first < count; first += batch)
+				{
+					std::size_t const size = std::min(batch, count - first);
+					a(binary_data(static_cast<float*>(buffer), size * sizeof(float)));
+					for (std::size_t i = 0; i < size; ++i)
+					{
+						data[(first + i) * components + c] = buffer[i];
+					}
+				}
+			}
 		}
 	}
 
+	namespace ue4
+	{
+		template < typename T >
+		struct wrapper_codec< Columnar< T > > : std::true_type
+		{
+			template < typename A >
+			static void save(A& a, Columnar< T > const& in)
+			{
+				save_columnar(a, in.value);
+			}
+
+			template < typename A >
+			static void load(A& a, Columnar< T >& out)
+			{
+				load_columnar(a, out.value);
+			}
+		};
+	}
+
 	template < typename A, int32 B, bool S >
-	inline void save(A& a, const TBigInt< B, S >& in)
+	inline typename std::enable_if< !ue4::is_compact_output< A >::value >::type
+	save(A& a, const TBigInt< B, S >& in)
 	{
 		a(make_nvp("hex", std::string(TCHAR_TO_UTF8(*in.ToString()))));
 	}
 
 	template < typename A, int32 B, bool S >
-    inline void load(A& a, TBigInt< B, S >& out)
+	inline typename std::enable_if< !ue4::is_compact_input< A >::value >::type
+	load(A& a, TBigInt< B, S >& out)
 	{
 		std::string buffer;
 		a(make_nvp("hex", buffer));
 		out.Parse(FString(UTF8_TO_TCHAR(buffer.data())));
 	}
 
+	// Compact binary archives (see ue4::has_compact_format) write the word array, least significant word first.
+	// Portable archives byte swap each word.
+	template < typename A, int32 B, bool S >
+	inline typename std::enable_if< ue4::is_compact_output< A >::value >::type
+	save(A& a, const TBigInt< B, S >& in)
+	{
+		a(binary_data(in.GetBits(), TBigInt< B, S >::NumWords * sizeof(uint32)));
+	}
+
+	template < typename A, int32 B, bool S >
+	inline typename std::enable_if< ue4::is_compact_input< A >::value >::type
+	load(A& a, TBigInt< B, S >& out)
+	{
+		a(binary_data(out.GetBits(), TBigInt< B, S >::NumWords * sizeof(uint32)));
+	}
+
 	template < typename A, typename E >
-	inline void serialize(A& a, TInterval< E >& in)
+	inline typename std::enable_if< !ue4::is_binary_blob< A, TInterval< E > >::value >::type
+	serialize(A& a, TInterval< E >& in)
 	{
 		a(make_nvp("Min", in.Min), make_nvp("Max", in.Max));
 	}
@@ -529,22 +3113,50 @@ namespace cereal
 		}
 	}
 
+	namespace ue4
+	{
+		/**
+		 * @brief Loads one entry written by make_map_item into Map. The key is read first and the value is then loaded
+		 * straight into the pair emplaced for it, so only the key ever lives outside the map. Values with
+		 * load_and_construct cannot be default constructed in place and are built before being moved in.
+		 */
+		template < typename K, typename V, typename L, typename F >
+		struct map_entry_loader
+		{
+			TMap< K, V, L, F >& Map;
+
+			template < typename A >
+			typename std::enable_if< !traits::has_load_and_construct< V, A >::value >::type
+			CEREAL_LOAD_FUNCTION_NAME(A& a)
+			{
+				loaded_value< A, K > key(a, "key");
+				a(make_nvp("value", Map.Emplace(MoveTemp(key.get()))));
+			}
+
+			template < typename A >
+			typename std::enable_if< traits::has_load_and_construct< V, A >::value >::type
+			CEREAL_LOAD_FUNCTION_NAME(A& a)
+			{
+				loaded_value< A, K > key(a, "key");
+				loaded_value< A, V > value(a, "value");
+				Map.Emplace(MoveTemp(key.get()), MoveTemp(value.get()));
+			}
+		};
+	}
+
 	template < typename A, typename K, typename V, typename L, typename F >
-    inline void CEREAL_LOAD_FUNCTION_NAME(A& a, TMap< K, V, L, F >& out)
+	inline void CEREAL_LOAD_FUNCTION_NAME(A& a, TMap< K, V, L, F >& out)
 	{
 		size_type size;
 		a(make_size_tag(size));
 
-		out.Empty();
-		out.Reserve(size);
+		// Same as Empty() then Reserve(size): the hash is sized for every entry before the first insert.
+		out.Empty(static_cast<int32>(size));
 
+		ue4::map_entry_loader< K, V, L, F > entry{ out };
 		for (size_type i = 0; i < size; ++i)
 		{
-			K key;
-			V value;
-
-			a(make_map_item(key, value));
-			out.Emplace(MoveTemp(key), MoveTemp(value));
+			a(entry);
 		}
 	}
 
@@ -565,8 +3177,7 @@ namespace cereal
 		size_type size;
 		a(make_size_tag(size));
 
-		out.Empty();
-		out.Reserve(size);
+		out.Empty(static_cast<int32>(size));
 
 		for (size_type i = 0; i < size; ++i)
 		{
@@ -576,5 +3187,285 @@ namespace cereal
 			out.Emplace(MoveTemp(e));
 		}
 	}
+
+	/**
+	 * @brief Wrapper selecting the layout snapshot encoding for a TMap or TSet in binary archives. Create with
+	 * make_layout_snapshot. Text archives serialize the wrapped container unchanged.
+	 *
+	 * The snapshot stores every entry's key hash next to it, in iteration order, under a fingerprint of the build
+	 * (CEREAL_UE4_LAYOUT_FINGERPRINT) and platform. A load with a matching fingerprint re-adds the entries by their
+	 * stored hashes without calling GetTypeHash; any other load ignores the hashes and rehashes the keys. Only key
+	 * types marked with ue4::has_stable_key_hash are accepted. FName, UObject pointers and other pointer keys hash
+	 * name table indices or addresses, which differ between runs of the same build, so their hashes would be useless.
+	 */
+	template < typename T >
+	struct LayoutSnapshot
+	{
+		T value;
+	};
+
+	/**
+	 * @brief Serializes the TMap or TSet v as a layout snapshot.
+	 */
+	template < typename T >
+	inline LayoutSnapshot< T > make_layout_snapshot(T&& v)
+	{
+		return { std::forward< T >(v) };
+	}
+
+	namespace ue4
+	{
+		/**
+		 * @brief True for key types whose GetTypeHash depends only on their contents, the build and the platform, so a
+		 * layout snapshot's stored hashes stay valid in a later run of the same build. Specialize it for project types
+		 * whose hash qualifies; keys hashed by address or by an index assigned at run time must not be marked.
+		 */
+		template < typename K >
+		struct has_stable_key_hash : std::integral_constant< bool, std::is_arithmetic< K >::value || std::is_enum< K >::value >
+		{};
+
+		template <>
+		struct has_stable_key_hash< FString > : std::true_type
+		{};
+
+		template <>
+		struct has_stable_key_hash< FGuid > : std::true_type
+		{};
+
+		/**
+		 * @brief Platform properties that key hashes may depend on: the pointer size, with the top bit set on little
+		 * endian platforms.
+		 */
+		constexpr uint8 layout_platform()
+		{
+			return static_cast<uint8>(sizeof(void*) | (PLATFORM_LITTLE_ENDIAN ? 0x80 : 0));
+		}
+
+		template < typename A >
+		inline void save_layout_header(A& a)
+		{
+			uint64 const fingerprint = CEREAL_UE4_LAYOUT_FINGERPRINT;
+			uint8 const platform = layout_platform();
+			save_fixed(a, fingerprint);
+			a(platform);
+		}
+
+		/**
+		 * @brief Reads the snapshot header and returns true if its hashes can be trusted by this build.
+		 */
+		template < typename A >
+		inline bool load_layout_header(A& a)
+		{
+			uint64 fingerprint;
+			uint8 platform;
+			load_fixed(a, fingerprint);
+			a(platform);
+			return fingerprint == static_cast<uint64>(CEREAL_UE4_LAYOUT_FINGERPRINT) && platform == layout_platform();
+		}
+
+		template < typename A, typename K, typename V, typename L, typename F >
+		inline void save_layout(A& a, TMap< K, V, L, F > const& in)
+		{
+			static_assert(has_stable_key_hash< K >::value, "make_layout_snapshot requires a key type marked with has_stable_key_hash");
+			save_layout_header(a);
+			a(make_size_tag(static_cast<size_type>(in.Num())));
+			for (auto const& p : in)
+			{
+				uint32 const hash = F::GetKeyHash(p.Key);
+				save_fixed(a, hash);
+				a(p.Key, p.Value);
+			}
+		}
+
+		template < typename A, typename K, typename V, typename L, typename F >
+		inline void load_layout(A& a, TMap< K, V, L, F >& out)
+		{
+			static_assert(has_stable_key_hash< K >::value, "make_layout_snapshot requires a key type marked with has_stable_key_hash");
+			bool const trusted = load_layout_header(a);
+			size_type size;
+			a(make_size_tag(size));
+
+			out.Empty(static_cast<int32>(size));
+			for (size_type i = 0; i < size; ++i)
+			{
+				uint32 hash;
+				load_fixed(a, hash);
+				loaded_value< A, K > key(a, "key");
+				loaded_value< A, V > value(a, "value");
+				if (trusted)
+				{
+					out.AddByHash(hash, MoveTemp(key.get()), MoveTemp(value.get()));
+				}
+				else
+				{
+					out.Emplace(MoveTemp(key.get()), MoveTemp(value.get()));
+				}
+			}
+		}
+
+		template < typename A, typename E, typename K, typename L >
+		inline void save_layout(A& a, TSet< E, K, L > const& in)
+		{
+			using key_type = typename std::decay< decltype(K::GetSetKey(std::declval< E const& >())) >::type;
+			static_assert(has_stable_key_hash< key_type >::value, "make_layout_snapshot requires a key type marked with has_stable_key_hash");
+			save_layout_header(a);
+			a(make_size_tag(static_cast<size_type>(in.Num())));
+			for (auto const& e : in)
+			{
+				uint32 const hash = K::GetKeyHash(K::GetSetKey(e));
+				save_fixed(a, hash);
+				a(e);
+			}
+		}
+
+		template < typename A, typename E, typename K, typename L >
+		inline void load_layout(A& a, TSet< E, K, L >& out)
+		{
+			using key_type = typename std::decay< decltype(K::GetSetKey(std::declval< E const& >())) >::type;
+			static_assert(has_stable_key_hash< key_type >::value, "make_layout_snapshot requires a key type marked with has_stable_key_hash");
+			bool const trusted = load_layout_header(a);
+			size_type size;
+			a(make_size_tag(size));
+
+			out.Empty(static_cast<int32>(size));
+			for (size_type i = 0; i < size; ++i)
+			{
+				uint32 hash;
+				load_fixed(a, hash);
+				loaded_value< A, E > e(a, "element");
+				if (trusted)
+				{
+					out.AddByHash(hash, MoveTemp(e.get()));
+				}
+				else
+				{
+					out.Emplace(MoveTemp(e.get()));
+				}
+			}
+		}
+	}
+
+	namespace ue4
+	{
+		template < typename T >
+		struct wrapper_codec< LayoutSnapshot< T > > : std::true_type
+		{
+			template < typename A >
+			static void save(A& a, LayoutSnapshot< T > const& in)
+			{
+				save_layout(a, in.value);
+			}
+
+			template < typename A >
+			static void load(A& a, LayoutSnapshot< T >& out)
+			{
+				load_layout(a, out.value);
+			}
+		};
+	}
+
+	namespace ue4
+	{
+		/**
+		 * @brief Default key order for make_sorted: operator<, except that FNames compare as strings, since their
+		 * usual order depends on name table indices that differ between runs.
+		 */
+		struct key_less
+		{
+			template < typename T >
+			bool operator()(T const& x, T const& y) const
+			{
+				return x < y;
+			}
+
+			bool operator()(FName const& x, FName const& y) const
+			{
+				return x.LexicalLess(y);
+			}
+		};
+	}
+
+	/**
+	 * @brief Wrapper that saves a TMap or TSet with its entries sorted by key, so logically equal containers produce
+	 * identical bytes. Create with make_sorted. The output is the container's usual format in every archive and loads
+	 * with or without the wrapper.
+	 */
+	template < typename T, typename C = ue4::key_less >
+	struct Sorted
+	{
+		T value;
+		C less;
+	};
+
+	/**
+	 * @brief Serializes the TMap or TSet v in key order, as given by less.
+	 */
+	template < typename T, typename C = ue4::key_less >
+	inline Sorted< T, C > make_sorted(T&& v, C const& less = C())
+	{
+		return { std::forward< T >(v), less };
+	}
+
+	namespace ue4
+	{
+		/**
+		 * @brief Sorts pointers to the elements of in by the key that key_of returns, leaving the container itself
+		 * untouched and copying no elements.
+		 */
+		template < typename S, typename G, typename C >
+		inline TArray< typename S::ElementType const* > sorted_elements(S const& in, G const& key_of, C const& less)
+		{
+			using element = typename S::ElementType;
+
+			TArray< element const* > order;
+			order.Reserve(in.Num());
+			for (auto const& e : in)
+			{
+				order.Add(&e);
+			}
+			std::sort(order.GetData(), order.GetData() + order.Num(), [&](element const* x, element const* y)
+			{
+				return less(key_of(*x), key_of(*y));
+			});
+			return order;
+		}
+
+		template < typename A, typename K, typename V, typename L, typename F, typename C >
+		inline void save_sorted(A& a, TMap< K, V, L, F > const& in, C const& less)
+		{
+			using element = typename TMap< K, V, L, F >::ElementType;
+
+			auto const order = sorted_elements(in, [](element const& p) -> K const& { return p.Key; }, less);
+			a(make_size_tag(static_cast<size_type>(order.Num())));
+			for (element const* p : order)
+			{
+				a(make_map_item(p->Key, p->Value));
+			}
+		}
+
+		template < typename A, typename E, typename K, typename L, typename C >
+		inline void save_sorted(A& a, TSet< E, K, L > const& in, C const& less)
+		{
+			auto const order = sorted_elements(in, [](E const& e) -> decltype(K::GetSetKey(e)) { return K::GetSetKey(e); }, less);
+			a(make_size_tag(static_cast<size_type>(order.Num())));
+			for (E const* e : order)
+			{
+				a(*e);
+			}
+		}
+	}
+
+	// Sorted writes no wrapper of its own; the container's saver and loader handle its node in text archives.
+	template < typename A, typename T, typename C >
+	inline void CEREAL_SAVE_FUNCTION_NAME(A& a, const Sorted< T, C >& in)
+	{
+		ue4::save_sorted(a, in.value, in.less);
+	}
+
+	template < typename A, typename T, typename C >
+	inline void CEREAL_LOAD_FUNCTION_NAME(A& a, Sorted< T, C >& out)
+	{
+		CEREAL_LOAD_FUNCTION_NAME(a, out.value);
+	}
 }
 #endif
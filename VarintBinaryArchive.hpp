@@ -0,0 +1,250 @@
+#ifndef __VARINTBINARYARCHIVE_HPP__
+#define __VARINTBINARYARCHIVE_HPP__
+
+#include <cereal/cereal.hpp>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include "UE4Serialization.hpp"
+
+namespace cereal
+{
+	/**
+	* @brief Binary output archive for integer-heavy data. Integers wider than a byte and all size tags are written as
+	* LEB128 varints, signed values zig-zag encoded first, so small values of either sign take one or two bytes.
+	* Bytes, bools, floating point values and binary_data are written raw in native byte order, as BinaryOutputArchive
+	* writes them. TSubclassOf registration ids are counted from the first generated id, so they take one or two bytes
+	* too, and FColor keeps its raw four bytes. Values that are usually large, class path hashes, layout snapshot hashes
+	* and FDateTime and FTimespan ticks, are written raw at their full width. The archive always uses the compact
+	* encodings of ue4::has_compact_format. Load with VarintBinaryInputArchive.
+	*
+	* When using a file stream, open it with std::ios::binary.
+	*/
+	class VarintBinaryOutputArchive : public OutputArchive< VarintBinaryOutputArchive, AllowEmptyClassElision >
+	{
+	public:
+		/**
+		 * @brief Construct, outputting to the provided stream.
+		 */
+		VarintBinaryOutputArchive(std::ostream& stream)
+			: OutputArchive< VarintBinaryOutputArchive, AllowEmptyClassElision >(this)
+			, itsStream(stream)
+		{}
+
+		~VarintBinaryOutputArchive() CEREAL_NOEXCEPT = default;
+
+		/**
+		 * @brief Writes size bytes of data to the output stream.
+		 */
+		void saveBinary(const void* data, std::streamsize size)
+		{
+			auto const writtenSize = itsStream.rdbuf()->sputn(reinterpret_cast<const char*>(data), size);
+
+			if (writtenSize != size)
+			{
+				throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+			}
+		}
+
+		/**
+		 * @brief Writes v as a LEB128 varint: seven bits per byte, least significant group first, high bit set on every
+		 * byte but the last. The same encoding as ue4::save_varint.
+		 */
+		void saveVarint(uint64 v)
+		{
+			char buffer[10];
+			std::streamsize size = 0;
+			while (v >= 0x80)
+			{
+				buffer[size++] = static_cast<char>(v | 0x80);
+				v >>= 7;
+			}
+			buffer[size++] = static_cast<char>(v);
+			saveBinary(buffer, size);
+		}
+
+	private:
+		std::ostream& itsStream;
+	};
+
+	/**
+	* @brief Input archive for data saved with VarintBinaryOutputArchive.
+	*/
+	class VarintBinaryInputArchive : public InputArchive< VarintBinaryInputArchive, AllowEmptyClassElision >
+	{
+	public:
+		/**
+		 * @brief Construct, loading from the provided stream.
+		 */
+		VarintBinaryInputArchive(std::istream& stream)
+			: InputArchive< VarintBinaryInputArchive, AllowEmptyClassElision >(this)
+			, itsStream(stream)
+		{}
+
+		~VarintBinaryInputArchive() CEREAL_NOEXCEPT = default;
+
+		/**
+		 * @brief Reads size bytes of data from the input stream.
+		 */
+		void loadBinary(void* const data, std::streamsize size)
+		{
+			auto const readSize = itsStream.rdbuf()->sgetn(reinterpret_cast<char*>(data), size);
+
+			if (readSize != size)
+			{
+				throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+			}
+		}
+
+		/**
+		 * @brief Reads a LEB128 varint. Bytes come straight from the stream buffer's inline sbumpc, and the loop's only
+		 * data dependent branch is the continuation bit; single byte values, the common case, leave after one test.
+		 * Throws if the value does not fit 64 bits, so the tenth byte may only be 0 or 1.
+		 */
+		uint64 loadVarint()
+		{
+			std::streambuf& buffer = *itsStream.rdbuf();
+			int const first = buffer.sbumpc();
+			if (static_cast<unsigned>(first) < 0x80)
+			{
+				return static_cast<uint64>(first);
+			}
+
+			uint64 v = static_cast<uint64>(first & 0x7f);
+			int byte = first;
+			for (unsigned shift = 7; (byte & 0x80) != 0; shift += 7)
+			{
+				byte = buffer.sbumpc();
+				if (byte == std::char_traits<char>::eof())
+				{
+					throw Exception("Failed to read varint from input stream");
+				}
+				if (shift == 63 && byte > 1)
+				{
+					throw Exception("Malformed varint");
+				}
+				v |= static_cast<uint64>(byte & 0x7f) << shift;
+			}
+			return v;
+		}
+
+	private:
+		std::istream& itsStream;
+	};
+
+	namespace ue4
+	{
+		template <>
+		struct has_compact_integers< VarintBinaryOutputArchive > : std::true_type
+		{};
+
+		template <>
+		struct has_compact_integers< VarintBinaryInputArchive > : std::true_type
+		{};
+
+		/**
+		 * @brief Types VarintBinaryOutputArchive writes raw: bools, single bytes and floating point values.
+		 */
+		template < typename T >
+		struct is_varint_raw
+			: std::integral_constant< bool, std::is_arithmetic< T >::value && (sizeof(T) == 1 || std::is_floating_point< T >::value) >
+		{};
+
+		template < typename T >
+		struct is_varint_unsigned
+			: std::integral_constant< bool, std::is_integral< T >::value && std::is_unsigned< T >::value && sizeof(T) != 1 >
+		{};
+
+		template < typename T >
+		struct is_varint_signed
+			: std::integral_constant< bool, std::is_integral< T >::value && std::is_signed< T >::value && sizeof(T) != 1 >
+		{};
+	}
+
+	template < class T >
+	inline typename std::enable_if< ue4::is_varint_raw< T >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(VarintBinaryOutputArchive& ar, T const& t)
+	{
+		ar.saveBinary(std::addressof(t), sizeof(t));
+	}
+
+	template < class T >
+	inline typename std::enable_if< ue4::is_varint_raw< T >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(VarintBinaryInputArchive& ar, T& t)
+	{
+		ar.loadBinary(std::addressof(t), sizeof(t));
+	}
+
+	template < class T >
+	inline typename std::enable_if< ue4::is_varint_unsigned< T >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(VarintBinaryOutputArchive& ar, T const& t)
+	{
+		ar.saveVarint(static_cast<uint64>(t));
+	}
+
+	template < class T >
+	inline typename std::enable_if< ue4::is_varint_unsigned< T >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(VarintBinaryInputArchive& ar, T& t)
+	{
+		uint64 const v = ar.loadVarint();
+		if (v > static_cast<uint64>(std::numeric_limits< T >::max()))
+		{
+			throw Exception("Varint out of range");
+		}
+		t = static_cast<T>(v);
+	}
+
+	template < class T >
+	inline typename std::enable_if< ue4::is_varint_signed< T >::value >::type
+	CEREAL_SAVE_FUNCTION_NAME(VarintBinaryOutputArchive& ar, T const& t)
+	{
+		ar.saveVarint(ue4::zigzag_encode(static_cast<int64>(t)));
+	}
+
+	template < class T >
+	inline typename std::enable_if< ue4::is_varint_signed< T >::value >::type
+	CEREAL_LOAD_FUNCTION_NAME(VarintBinaryInputArchive& ar, T& t)
+	{
+		int64 const v = ue4::zigzag_decode(ar.loadVarint());
+		if (v < static_cast<int64>(std::numeric_limits< T >::min()) || v > static_cast<int64>(std::numeric_limits< T >::max()))
+		{
+			throw Exception("Varint out of range");
+		}
+		t = static_cast<T>(v);
+	}
+
+	template < class Archive, class T >
+	inline CEREAL_ARCHIVE_RESTRICT(VarintBinaryInputArchive, VarintBinaryOutputArchive)
+	CEREAL_SERIALIZE_FUNCTION_NAME(Archive& ar, NameValuePair< T >& t)
+	{
+		ar(t.value);
+	}
+
+	// size_type is unsigned, so size tags become varints.
+	template < class Archive, class T >
+	inline CEREAL_ARCHIVE_RESTRICT(VarintBinaryInputArchive, VarintBinaryOutputArchive)
+	CEREAL_SERIALIZE_FUNCTION_NAME(Archive& ar, SizeTag< T >& t)
+	{
+		ar(t.size);
+	}
+
+	template < class T >
+	inline void CEREAL_SAVE_FUNCTION_NAME(VarintBinaryOutputArchive& ar, BinaryData< T > const& bd)
+	{
+		ar.saveBinary(bd.data, static_cast<std::streamsize>(bd.size));
+	}
+
+	template < class T >
+	inline void CEREAL_LOAD_FUNCTION_NAME(VarintBinaryInputArchive& ar, BinaryData< T >& bd)
+	{
+		ar.loadBinary(bd.data, static_cast<std::streamsize>(bd.size));
+	}
+}
+
+CEREAL_REGISTER_ARCHIVE(cereal::VarintBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::VarintBinaryInputArchive)
+
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::VarintBinaryInputArchive, cereal::VarintBinaryOutputArchive)
+
+#endif